@@ -0,0 +1,65 @@
+#include "AnalysisWorker.h"
+#include "SharedBuffer.h"
+
+#include <chrono>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr auto kPollInterval = std::chrono::milliseconds(2);	// a few times per tick, results are a tick late at worst
+}
+
+AnalysisWorker& AnalysisWorker::get()
+{
+	static AnalysisWorker worker;
+	return worker;
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+	stop();
+}
+
+bool AnalysisWorker::start()
+{
+	std::lock_guard<std::mutex> lock(controlMutex);
+	if (running.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	running.store(true, std::memory_order_release);
+	thread = std::thread(&AnalysisWorker::run, this);
+	return true;
+}
+
+void AnalysisWorker::stop()
+{
+	std::lock_guard<std::mutex> lock(controlMutex);
+	if (!running.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	running.store(false, std::memory_order_release);
+	thread.join();
+}
+
+void AnalysisWorker::run()
+{
+#if defined(__linux__)
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);	// the thread's nice value, audio threads come first
+#endif
+
+	while (running.load(std::memory_order_acquire))
+	{
+		for (AkInt32 group = 0; group < GlobalManager::kNumGroups; ++group)
+		{
+			GlobalManager::getGlobalSharedBuffer(group)->runAnalysis();
+		}
+		std::this_thread::sleep_for(kPollInterval);
+	}
+}
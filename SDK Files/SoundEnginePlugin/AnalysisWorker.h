@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Optional low-priority thread for the slow-moving statistics of the sidechain busses: the level sketches of the auto threshold
+// and the priority range. The instance closing a tick hands its bus's summary over through a wait-free ring and picks up whatever
+// the worker published last (SharedBuffer::submitAnalysis and applyAnalysis), so it pays the same small cost every tick.
+// Until start() is called, and again after stop(), the closing instance runs the analysis itself right after handing the summary
+// over, which gives the same results on the same tick on every run. The tools and host-less tests rely on that.
+class AnalysisWorker
+{
+public:
+	static AnalysisWorker& get();
+	~AnalysisWorker();
+
+	bool start();											// from game code, false if the worker was already running
+	void stop();											// joins the thread, the busses go back to analyzing on the tick close
+	bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+private:
+	AnalysisWorker() = default;
+	void run();
+
+	std::atomic<bool> running = false;
+	std::thread thread;
+	std::mutex controlMutex;								// start() and stop(), never taken by the audio threads
+};
@@ -25,9 +25,15 @@ the specific language governing permissions and limitations under the License.
 *******************************************************************************/
 
 #include "AutoCompressorFX.h"
+#include "Decibels.h"
+#include "TraceRecorder.h"
 #include "../AutoCompressorConfig.h"
 
 #include <AK/AkWwiseSDKVersion.h>
+#include <AK/SoundEngine/Common/AkSimd.h>
+
+#include <cstdio>
+#include <cstring>
 
 AK::IAkPlugin* CreateAutoCompressorFX(AK::IAkPluginMemAlloc* in_pAllocator)
 {
@@ -41,6 +47,9 @@ AK::IAkPluginParam* CreateAutoCompressorFXParams(AK::IAkPluginMemAlloc* in_pAllo
 
 AK_IMPLEMENT_PLUGIN_FACTORY(AutoCompressorFX, AkPluginTypeEffect, AutoCompressorConfig::CompanyID, AutoCompressorConfig::PluginID)
 
+static_assert(MAX_BANDS == Crossover::kMaxBands, "the Bands parameter must fit the crossover");
+static_assert(NUM_GROUPS == GlobalManager::kNumGroups, "the Group parameter must fit the sidechain busses");
+
 AutoCompressorFX::AutoCompressorFX()
     : m_pParams(nullptr)
     , m_pAllocator(nullptr)
@@ -59,20 +68,34 @@ AKRESULT AutoCompressorFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkEff
     m_pContext = in_pContext;
 
     sampleRate = in_rFormat.uSampleRate;
+    numChannels = in_rFormat.channelConfig.uNumChannels;
+
+    maxFrames = GlobalManager::getMaxBufferLength();
 
     if (in_pContext != nullptr)
     {
         objectID = in_pContext->GetAudioNodeID();
-        g_SharedBuffer->addToObjectList(objectID);
+        AK::IAkGameObjectPluginInfo* gameObjectInfo = in_pContext->GetGameObjectInfo();
+        gameObject = (gameObjectInfo != nullptr) ? gameObjectInfo->GetGameObjectID() : AK_INVALID_GAME_OBJECT;     // none on busses
+        maxFrames = in_pContext->GlobalContext()->GetMaxBufferLength();
+    }
+
+    // Several voices of the same sound share an audio node ID, so every instance gets its own slot on the bus
+    if (!joinGroup(m_pParams->NonRTPC.iGroup))
+    {
+        return AK_InsufficientMemory;
     }
+    GlobalManager::reserveForMoves(sampleRate, maxFrames);
    
     return AK_Success;
 }
 
 AKRESULT AutoCompressorFX::Term(AK::IAkPluginMemAlloc* in_pAllocator)
 {
-    g_SharedBuffer->removeFromObjectList(objectID);
-    g_SharedBuffer->removeFromPriorityList(priority);
+    if (g_SharedBuffer != nullptr)
+    {
+        g_SharedBuffer->unregisterInstance(slot);
+    }
     AK_PLUGIN_DELETE(in_pAllocator, this);
     return AK_Success;
 }
@@ -95,6 +118,97 @@ AKRESULT AutoCompressorFX::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
 
 void AutoCompressorFX::Execute(AkAudioBuffer* io_pBuffer)
 {
+    TIMELINE_SCOPE("Execute", group, slot, g_SharedBuffer->tickCount);
+    executeStart = std::chrono::steady_clock::now();                    // what this instance costs counts towards its group's CPU budget
+    TickContext context;
+    if (beginTick(io_pBuffer, context))
+    {
+        processTick(io_pBuffer, context);
+    }
+    endTick(io_pBuffer, context);
+}
+
+void AutoCompressorFX::ExecuteBatch(AutoCompressorFX* const* in_ppInstances, AkAudioBuffer* const* io_ppBuffers, AkUInt16 in_uNumInstances)
+{
+    TIMELINE_SCOPE("ExecuteBatch");
+
+    // a chunk at a time so the contexts fit on the stack, each chunk is as good as calling Execute on its instances in turn
+    constexpr AkUInt16 kChunkInstances = 64;
+    TickContext contexts[kChunkInstances];
+    bool gainStage[kChunkInstances];
+
+    for (AkUInt16 chunkStart = 0; chunkStart < in_uNumInstances; chunkStart += kChunkInstances)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const AkUInt16 chunkInstances = static_cast<AkUInt16>(AkMin(kChunkInstances, in_uNumInstances - chunkStart));
+        AutoCompressorFX* const* instances = in_ppInstances + chunkStart;
+        AkAudioBuffer* const* buffers = io_ppBuffers + chunkStart;
+
+        // nothing an instance does before its gain stage depends on another's gain stage, only the tick closes need them all
+        for (AkUInt16 k = 0; k < chunkInstances; ++k)
+        {
+            gainStage[k] = instances[k]->beginTick(buffers[k], contexts[k]);
+        }
+
+        // lanes are filled in order with instances of the same buffer geometry, whatever doesn't fit a lane runs on its own
+        AkUInt16 pending[kLanes];
+        AkUInt16 numPending = 0;
+        auto flushPending = [&]()
+        {
+            for (AkUInt16 lane = 0; lane < numPending; ++lane)
+            {
+                instances[pending[lane]]->processTick(buffers[pending[lane]], contexts[pending[lane]]);
+            }
+            numPending = 0;
+        };
+        for (AkUInt16 k = 0; k < chunkInstances; ++k)
+        {
+            if (!gainStage[k])
+            {
+                continue;
+            }
+            const GainSettings& settings = contexts[k].settings[0];
+            if (instances[k]->numBands > 1 || settings.step > 1 || settings.hold)
+            {
+                instances[k]->processTick(buffers[k], contexts[k]);
+                continue;
+            }
+            if (numPending > 0 && (buffers[k]->uValidFrames != buffers[pending[0]]->uValidFrames
+                || buffers[k]->NumChannels() != buffers[pending[0]]->NumChannels()))
+            {
+                flushPending();
+            }
+            pending[numPending++] = k;
+            if (numPending == kLanes)
+            {
+                AutoCompressorFX* lanes[kLanes];
+                AkAudioBuffer* laneBuffers[kLanes];
+                const TickContext* laneContexts[kLanes];
+                for (AkUInt16 lane = 0; lane < kLanes; ++lane)
+                {
+                    lanes[lane] = instances[pending[lane]];
+                    laneBuffers[lane] = buffers[pending[lane]];
+                    laneContexts[lane] = &contexts[pending[lane]];
+                }
+                processTickLanes(lanes, laneBuffers, laneContexts);
+                numPending = 0;
+            }
+        }
+        flushPending();
+
+        // the chunk's time is shared evenly between its instances for the CPU governor, then each adds its own endTick
+        const auto share = (std::chrono::steady_clock::now() - start) / chunkInstances;
+        for (AkUInt16 k = 0; k < chunkInstances; ++k)
+        {
+            instances[k]->executeStart = std::chrono::steady_clock::now() - share;
+            instances[k]->endTick(buffers[k], contexts[k]);
+        }
+    }
+}
+
+bool AutoCompressorFX::beginTick(AkAudioBuffer* io_pBuffer, TickContext& context)
+{
+    TIMELINE_SCOPE("beginTick", group, slot, g_SharedBuffer->tickCount);
     const AkUInt32 uNumChannels = io_pBuffer->NumChannels();
     AkUInt32 frames10ms = static_cast<AkUInt32>(sampleRate / 100);
     AkReal32 thresholdDB = m_pParams->RTPC.fThreshold;      // unaffected by envelope     
@@ -105,185 +219,818 @@ void AutoCompressorFX::Execute(AkAudioBuffer* io_pBuffer)
     AkReal32 overshootA = static_cast<AkReal32>(max(epsilon, 0.3f));
     AkReal32 release = max(epsilon, m_pParams->RTPC.fRelease);             // in seconds, minimum of 0
     AkReal32 overshootR = static_cast<AkReal32>(max(epsilon, 0.01f));
-    AkReal32 gainDB[2] = { 0.0f, 0.0f };
     AkReal32 peak_decay = static_cast<AkReal32>(3.0 / sampleRate);          // DB decreased every frame, positive (3 DB over 1 second)
-    auto& oldSBRMS = g_SharedBuffer->lastbuffer_mRMS;
-    auto& newSBRMS = g_SharedBuffer->newbuffer_mRMS;
-    AkReal32 movingSBRMS[2]{ 0.0f, 0.0f };                                                  // the current mRMS of shared buffer, effectively the sidechain signal
-    AkReal32 rmsDiff[2] = { g_SharedBuffer->diff_mRMS[0], g_SharedBuffer->diff_mRMS[1] };
-    AkUInt16 refCount = static_cast<AkUInt16>(g_SharedBuffer->objectList.size());           // number of instances of this plugin
-
-    g_SharedBuffer->addToPriorityList(priority);
-    g_SharedBuffer->resizeSharedBuffer(io_pBuffer);
-    g_SharedBuffer->addToSharedBuffer(io_pBuffer);
-    g_SharedBuffer->numBuffersCalculated.fetch_add(1, std::memory_order_relaxed);
-
-    // Calculate realRatio from Priority
+    AkReal32 msWeight = 1.0f / (frames10ms * uNumChannels);                                 // weight of one new square in the moving mean square
+    AkReal32 (&startMS)[kNumKeys][2] = context.startMS;
+    std::copy(&instanceState->myMS[0][0], &instanceState->myMS[0][0] + (kNumKeys * 2), &startMS[0][0]);
+    context.msWeight = msWeight;
+
+    updateLayout();
+    context.refCount = g_SharedBuffer->numInstances;                                        // number of instances of this plugin
+
+    // Instances far under the rest of the group sit this tick out of the sidechain, see SharedBuffer::calculateCulling
+    AkReal32 channelMS[2] = { 0.0f, 0.0f };
+    for (AkUInt32 i = 0; i < AkMin(uNumChannels, 2); ++i)
+    {
+        const AkReal32* AK_RESTRICT pBuf = io_pBuffer->GetChannel(i);
+        for (AkUInt16 frame = 0; frame < io_pBuffer->uValidFrames; ++frame)
+        {
+            channelMS[i] += pBuf[frame] * pBuf[frame];
+        }
+        channelMS[i] /= AkMax(io_pBuffer->uValidFrames, 1);
+    }
+    instanceState->blockMS = (channelMS[0] + channelMS[1]) / AkMin(uNumChannels, 2);
+    instanceState->virtualized = 0;
+    if (instanceState->blockMS < g_SharedBuffer->cullFloorMS)
+    {
+        processCulled(io_pBuffer, channelMS, msWeight);
+        context.percentile = NAN;
+        return false;
+    }
+
+    g_SharedBuffer->addToSharedBuffer(slot, io_pBuffer, sampleRate);
+    if (numBands > 1)
+    {
+        g_SharedBuffer->setBandLayout(numBands, m_pParams->NonRTPC.fCrossover);
+    }
+    const bool autoThreshold = m_pParams->NonRTPC.bAutoThreshold;
+    if (autoThreshold)
+    {
+        g_SharedBuffer->setAutoThreshold(m_pParams->NonRTPC.fAutoPercentile, m_pParams->NonRTPC.fAutoHorizon);
+    }
+    g_SharedBuffer->getLeaveOneOutRMS(slot, instanceState->lastKeyRMS, instanceState->newKeyRMS);
+    buildSidechain(msWeight);
+
+    // points that fall before the first frame (buffers shorter than kEnvelopePoints) keep the level the tick started at
+    for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+    {
+        std::copy(&startMS[0][0], &startMS[0][0] + (kNumKeys * 2), &instanceState->envelopeMS[point][0][0]);
+    }
+
+    // Calculate realRatio from Priority, for every band
     AkReal32 percentile = static_cast<AkReal32>(g_SharedBuffer->getRatioPercentile(priority));
-    AkReal32 realRatio = (percentile * (maxRatio - 1)) + 1;
-    
-    // in case Wwise object didn't load during Init()
-    if (objectID = 0)
+    context.percentile = percentile;
+
+    // the group's CPU governor picks how often the gain computer runs, see SharedBuffer::calculateGovernor
+    const AkUInt8 tier = g_SharedBuffer->qualityTier;
+    const AkUInt16 step = (tier == SharedBuffer::tier_full) ? 1
+        : (tier == SharedBuffer::tier_subBlock) ? kSubBlockFrames
+        : static_cast<AkUInt16>(AkMax(io_pBuffer->uValidFrames / kEnvelopePoints, 1));
+    GainSettings (&settings)[kMaxBands] = context.settings;
+    for (AkUInt16 band = 0; band < numBands; ++band)
     {
-        objectID = m_pContext->GetAudioNodeID();
-        g_SharedBuffer->addToObjectList(objectID);
+        AkReal32 bandRatio = (numBands > 1) ? m_pParams->RTPC.fBandRatio[band] : maxRatio;
+        settings[band].key = (numBands > 1) ? SharedBuffer::kFullBandKey + 1 + band : SharedBuffer::kFullBandKey;
+        settings[band].thresholdDB = (numBands > 1) ? m_pParams->RTPC.fBandThreshold[band] : thresholdDB;
+        if (autoThreshold && !std::isnan(g_SharedBuffer->autoThresholdDB[settings[band].key]))
+        {
+            settings[band].thresholdDB = g_SharedBuffer->autoThresholdDB[settings[band].key];       // the fixed one is kept until the group was heard
+        }
+        settings[band].kneeDB = kneeDB;
+        settings[band].realRatio = (percentile * (bandRatio - 1)) + 1;
+        settings[band].attackRate = expf(-logf((1 + overshootA) / overshootA) / (attack * sampleRate));
+        settings[band].releaseRate = expf(-logf((1 + overshootR) / overshootR) / (release * sampleRate));
+        settings[band].overshootA = overshootA;
+        settings[band].overshootR = overshootR;
+        settings[band].msWeight = msWeight;
+        settings[band].step = step;
+        settings[band].attackStep = (step > 1) ? powf(settings[band].attackRate, step) : settings[band].attackRate;
+        settings[band].releaseStep = (step > 1) ? powf(settings[band].releaseRate, step) : settings[band].releaseRate;
+        settings[band].hold = m_pParams->NonRTPC.fHold > 0.0f;
+        gainCurve[band].setup(settings[band].thresholdDB, settings[band].kneeDB, settings[band].realRatio);
     }
-    
-    AkUInt16 uFramesProcessed;
+    return true;
+}
+
+void AutoCompressorFX::processTick(AkAudioBuffer* io_pBuffer, const TickContext& context)
+{
+    TIMELINE_SCOPE("processTick", group, slot, g_SharedBuffer->tickCount);
+    const AkUInt32 uNumChannels = AkMin(io_pBuffer->NumChannels(), 2);     // the per-instance state only has a left and a right, like processBands
+    const GainSettings (&settings)[kMaxBands] = context.settings;
+    const AkReal32 msWeight = context.msWeight;
     for (AkUInt32 i = 0; i < uNumChannels; ++i)
     {
         AkReal32* AK_RESTRICT pBuf = (AkReal32* AK_RESTRICT)io_pBuffer->GetChannel(i);
 
-        uFramesProcessed = 0;
-        auto& frame = uFramesProcessed;
-        const auto& maxFrames = io_pBuffer->uValidFrames;
-        
-
-        while (uFramesProcessed < io_pBuffer->uValidFrames)
+        if (numBands == 1)
+        {
+            processGain(settings[0], 0, static_cast<AkUInt16>(i), pBuf, 0, io_pBuffer->uValidFrames, io_pBuffer->uValidFrames);
+        }
+        else
         {
-            // Determine the RMS of sidechain signal (movingSBRMS), using data from the previous buffer tick.
-            // Also makes the difference of RMS between buffers smoother
+            // the full band key still gets this instance's dry level, for the full band instances of the group
+            AkReal32& fullBandMS = instanceState->myMS[SharedBuffer::kFullBandKey][i];
+            AkUInt16 frame = 0;
+            for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
             {
-                // Estimate current SBRMS (somewhere between oldSBRMS and newSBRMS, based on the % of progress through the total amount of frames in the buffer)
-                
-                movingSBRMS[i] = oldSBRMS[i] + ((frame / maxFrames) * (newSBRMS[i] - oldSBRMS[i]));
-                
-
-                // update new slope
-                AkReal32 mySlope = newSBRMS[i] - oldSBRMS[i];
-                if (abs(mySlope - rmsDiff[i]) < epsilon) // if difference is negligible, rmsDiff matches it
+                for (const AkUInt16 pointFrame = SharedBuffer::envelopeFrame(point + 1, io_pBuffer->uValidFrames); frame < pointFrame; ++frame)
                 {
-                    rmsDiff[i] = mySlope;
+                    fullBandMS += (pBuf[frame] * pBuf[frame] - fullBandMS) * msWeight;
                 }
-                else //shift rmsSlope toward the next RMS, at 50% strength
+                instanceState->envelopeMS[point][SharedBuffer::kFullBandKey][i] = fullBandMS;
+            }
+        }
+    }
+
+    if (numBands > 1)
+    {
+        processBands(io_pBuffer, settings);
+    }
+}
+
+void AutoCompressorFX::processTickLanes(AutoCompressorFX* const lanes[kLanes], AkAudioBuffer* const buffers[kLanes], const TickContext* const contexts[kLanes])
+{
+    TIMELINE_SCOPE("processTickLanes");
+
+    // Same steps as processGain at full quality, with lane l holding instance l. The sidechain and the envelope are computed
+    // side by side, the tables of each instance (level to dB, its static curve, dB to gain) are still read one lane at a time.
+    const AkUInt16 uNumChannels = static_cast<AkUInt16>(AkMin(buffers[0]->NumChannels(), 2));     // a left and a right, like processTick
+    const AkUInt16 uValidFrames = buffers[0]->uValidFrames;
+    const AkUInt16 key = SharedBuffer::kFullBandKey;
+    const AkReal32 pointsPerFrame = static_cast<AkReal32>(kEnvelopePoints) / uValidFrames;
+
+    alignas(16) AkReal32 msWeight[kLanes];
+    alignas(16) AkReal32 attackRate[kLanes];
+    alignas(16) AkReal32 attackOffset[kLanes];          // what the envelope ratio heads for, times (1 - rate)
+    alignas(16) AkReal32 releaseRate[kLanes];
+    alignas(16) AkReal32 releaseOffset[kLanes];
+    for (AkUInt16 lane = 0; lane < kLanes; ++lane)
+    {
+        const GainSettings& settings = contexts[lane]->settings[0];
+        msWeight[lane] = settings.msWeight;
+        attackRate[lane] = settings.attackRate;
+        attackOffset[lane] = static_cast<AkReal32>((1.0 + settings.overshootA) * (1.0 - settings.attackRate));
+        releaseRate[lane] = settings.releaseRate;
+        releaseOffset[lane] = static_cast<AkReal32>((-settings.overshootR) * (1.0 - settings.releaseRate));
+    }
+    const AKSIMD_V4F32 weight = AKSIMD_LOAD_V4F32(msWeight);
+    const AKSIMD_V4F32 rateA = AKSIMD_LOAD_V4F32(attackRate);
+    const AKSIMD_V4F32 offsetA = AKSIMD_LOAD_V4F32(attackOffset);
+    const AKSIMD_V4F32 rateR = AKSIMD_LOAD_V4F32(releaseRate);
+    const AKSIMD_V4F32 offsetR = AKSIMD_LOAD_V4F32(releaseOffset);
+    const AKSIMD_V4F32 zero = AKSIMD_SETZERO_V4F32();
+    const AKSIMD_V4F32 half = AKSIMD_SET_V4F32(0.5f);
+    const AKSIMD_V4F32 stateAttack = AKSIMD_SET_V4F32(static_cast<AkReal32>(env_attack));
+    const AKSIMD_V4F32 stateSustain = AKSIMD_SET_V4F32(static_cast<AkReal32>(env_sustain));
+    const AKSIMD_V4F32 stateRelease = AKSIMD_SET_V4F32(static_cast<AkReal32>(env_release));
+    const AKSIMD_V4F32 one = AKSIMD_SET_V4F32(1.0f);
+
+    for (AkUInt16 i = 0; i < uNumChannels; ++i)
+    {
+        AkReal32* pBuf[kLanes];
+        alignas(16) AkReal32 sidechain[kEnvelopePoints + 1][kLanes];
+        alignas(16) AkReal32 lanesMS[kLanes];
+        alignas(16) AkReal32 lanesTarget[kLanes];
+        alignas(16) AkReal32 lanesRatio[kLanes];
+        alignas(16) AkReal32 lanesOutput[kLanes];
+        alignas(16) AkReal32 lanesPeak[kLanes];
+        alignas(16) AkReal32 lanesState[kLanes];
+        for (AkUInt16 lane = 0; lane < kLanes; ++lane)
+        {
+            const InstancePool::State& state = *lanes[lane]->instanceState;
+            pBuf[lane] = buffers[lane]->GetChannel(i);
+            for (AkUInt16 point = 0; point <= kEnvelopePoints; ++point)
+            {
+                sidechain[point][lane] = lanes[lane]->sidechainRMS[key][i][point];
+            }
+            lanesMS[lane] = state.myMS[key][i];
+            lanesTarget[lane] = state.env_target[0][i];
+            lanesRatio[lane] = state.env_ratio[0][i];
+            lanesOutput[lane] = state.env_output[0][i];
+            lanesPeak[lane] = state.env_outputPeak[0][i];
+            lanesState[lane] = static_cast<AkReal32>(state.env_state[0]);     // shared by the channels, the second one starts where the first ended
+        }
+        AKSIMD_V4F32 keyMS = AKSIMD_LOAD_V4F32(lanesMS);
+        AKSIMD_V4F32 target = AKSIMD_LOAD_V4F32(lanesTarget);
+        AKSIMD_V4F32 ratio = AKSIMD_LOAD_V4F32(lanesRatio);
+        AKSIMD_V4F32 output = AKSIMD_LOAD_V4F32(lanesOutput);
+        AKSIMD_V4F32 peak = AKSIMD_LOAD_V4F32(lanesPeak);
+        AKSIMD_V4F32 state = AKSIMD_LOAD_V4F32(lanesState);
+
+        alignas(16) AkReal32 scratch[kLanes];
+        AkUInt16 point = 0;
+        AkUInt16 pointFrame = SharedBuffer::envelopeFrame(1, uValidFrames);
+        while (point < kEnvelopePoints && pointFrame == 0)
+        {
+            point++;
+            pointFrame = (point < kEnvelopePoints) ? SharedBuffer::envelopeFrame(point + 1, uValidFrames) : 0;
+        }
+
+        for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+        {
+            // myMS, and this instance's share of each envelope point
+            for (AkUInt16 lane = 0; lane < kLanes; ++lane)
+            {
+                scratch[lane] = pBuf[lane][frame];
+            }
+            const AKSIMD_V4F32 in = AKSIMD_LOAD_V4F32(scratch);
+            keyMS = AKSIMD_MADD_V4F32(AKSIMD_SUB_V4F32(AKSIMD_MUL_V4F32(in, in), keyMS), weight, keyMS);
+            while (frame + 1 == pointFrame)
+            {
+                AKSIMD_STORE_V4F32(scratch, keyMS);
+                for (AkUInt16 lane = 0; lane < kLanes; ++lane)
                 {
-                    rmsDiff[i] += static_cast<AkReal32>((mySlope - rmsDiff[i]) * (0.5));
+                    lanes[lane]->instanceState->envelopeMS[point][key][i] = scratch[lane];
                 }
+                point++;
+                pointFrame = (point < kEnvelopePoints) ? SharedBuffer::envelopeFrame(point + 1, uValidFrames) : 0;
+            }
 
-                // Update current RMS to follow rmsDiff/slope
-                movingSBRMS[i] += (rmsDiff[i] / maxFrames);
+            // the sidechain, interpolated between the envelope points of the last tick, through each instance's static curve
+            const AkReal32 position = (frame + 1) * pointsPerFrame;
+            const AkUInt16 segment = AkMin(static_cast<AkUInt16>(position), static_cast<AkUInt16>(kEnvelopePoints - 1));
+            const AkReal32 fraction = position - segment;
+            const AKSIMD_V4F32 from = AKSIMD_LOAD_V4F32(sidechain[segment]);
+            const AKSIMD_V4F32 movingSBRMS = AKSIMD_MADD_V4F32(AKSIMD_LOAD1_V4F32(fraction), AKSIMD_SUB_V4F32(AKSIMD_LOAD_V4F32(sidechain[segment + 1]), from), from);
+            AKSIMD_STORE_V4F32(scratch, movingSBRMS);
+            for (AkUInt16 lane = 0; lane < kLanes; ++lane)
+            {
+                scratch[lane] = lanes[lane]->gainCurve[0].gainDB(Decibels::fromLinear(scratch[lane]));
             }
+            target = AKSIMD_SUB_V4F32(zero, AKSIMD_LOAD_V4F32(scratch));
+
+            // stepEnvelope without branches: the attack and release steps of every lane, then a select of the one its state takes.
+            // A lane attacks when the target is over the output, releases from any other state but idle, and stays idle otherwise.
+            const AKSIMD_V4F32 notAttacking = AKSIMD_GTEQ_V4F32(output, target);
+            const AKSIMD_V4F32 active = AKSIMD_GTEQ_V4F32(state, half);
+            const AKSIMD_V4F32 attackRatio = AKSIMD_MADD_V4F32(ratio, rateA, offsetA);
+            const AKSIMD_V4F32 attackOutput = AKSIMD_MUL_V4F32(attackRatio, target);
+            const AKSIMD_V4F32 releaseRatio = AKSIMD_MADD_V4F32(ratio, rateR, offsetR);
+            const AKSIMD_V4F32 releaseOutput = AKSIMD_MUL_V4F32(releaseRatio, peak);
 
-            AkReal32 inputDB = AK_LINTODB(movingSBRMS[i]); // in case the first buffer is loud enough to trigger compressor
-            
-            // Calculate myRMS
-            myRMS[i] = sqrtf(
-                (
-                    (powf(myRMS[i], 2) * ((frames10ms * uNumChannels) - 1)    // a fake sum of previous frames' squares
-                        ) + powf(pBuf[frame], 2)                                      // add square of new sample
-                    ) / (frames10ms * uNumChannels)                                      // divide by frames to get new average of squares
-            );
-
-            // DSP section
+            const AKSIMD_V4F32 attackState = AKSIMD_VSEL_V4F32(stateAttack, stateSustain, AKSIMD_GTEQ_V4F32(attackRatio, one));
+            const AKSIMD_V4F32 releaseState = AKSIMD_VSEL_V4F32(zero, stateRelease, AKSIMD_GTEQ_V4F32(releaseRatio, zero));
+            const AKSIMD_V4F32 otherRatio = AKSIMD_VSEL_V4F32(ratio, AKSIMD_MAX_V4F32(releaseRatio, zero), active);
+            const AKSIMD_V4F32 otherOutput = AKSIMD_VSEL_V4F32(output, releaseOutput, active);
+            const AKSIMD_V4F32 otherState = AKSIMD_VSEL_V4F32(state, releaseState, active);
+
+            ratio = AKSIMD_VSEL_V4F32(AKSIMD_MIN_V4F32(attackRatio, one), otherRatio, notAttacking);
+            output = AKSIMD_VSEL_V4F32(attackOutput, otherOutput, notAttacking);
+            peak = AKSIMD_VSEL_V4F32(attackOutput, peak, notAttacking);
+            state = AKSIMD_VSEL_V4F32(attackState, otherState, notAttacking);
+
+            AKSIMD_STORE_V4F32(scratch, AKSIMD_SUB_V4F32(zero, output));
+            for (AkUInt16 lane = 0; lane < kLanes; ++lane)
             {
-                // Entire formula: https://www.desmos.com/calculator/eu6xlluw9h
-                // Calculate Compression DSP in DB
-                auto& x = inputDB;        // X = the DB of the Shared Buffer signal
-                AkReal32 y = x;                                 // base case, e.g. when no compression is needed, when shared buffer is below threshold and knee.
+                pBuf[lane][frame] *= Decibels::toLinear(scratch[lane]);
+            }
+        }
 
-                if (x > thresholdDB + (kneeDB / 2))             // if shared buffer exceeds both threshold and knee
-                {
-                    y = ((x - thresholdDB) / realRatio) + thresholdDB;
-                }
-                else if (x > thresholdDB - (kneeDB / 2))        // if shared buffer is above the lower bound of knee
+        AKSIMD_STORE_V4F32(lanesMS, keyMS);
+        AKSIMD_STORE_V4F32(lanesTarget, target);
+        AKSIMD_STORE_V4F32(lanesRatio, ratio);
+        AKSIMD_STORE_V4F32(lanesOutput, output);
+        AKSIMD_STORE_V4F32(lanesPeak, peak);
+        AKSIMD_STORE_V4F32(lanesState, state);
+        for (AkUInt16 lane = 0; lane < kLanes; ++lane)
+        {
+            InstancePool::State& laneState = *lanes[lane]->instanceState;
+            laneState.myMS[key][i] = lanesMS[lane];
+            laneState.env_target[0][i] = lanesTarget[lane];
+            laneState.env_ratio[0][i] = lanesRatio[lane];
+            laneState.env_output[0][i] = lanesOutput[lane];
+            laneState.env_outputPeak[0][i] = lanesPeak[lane];
+            laneState.mixOutput[0][i] = -lanesOutput[lane];
+            laneState.env_state[0] = static_cast<AkUInt8>(lanesState[lane]);
+        }
+    }
+}
+
+void AutoCompressorFX::endTick(AkAudioBuffer* io_pBuffer, const TickContext& context)
+{
+    TIMELINE_SCOPE("endTick", group, slot, g_SharedBuffer->tickCount);
+    if (std::isnan(context.percentile))
+    {
+        finishTick(io_pBuffer->uValidFrames, context.refCount, NAN);
+        return;
+    }
+
+    const AkUInt32 uNumChannels = io_pBuffer->NumChannels();
+    const AkReal32 (&startMS)[kNumKeys][2] = context.startMS;
+    AkReal32 msDecay[2] = { 1.0f, 1.0f };
+
+    // What this buffer added to myMS by each point, on top of whatever survived from the previous one
+    const AkReal32* decay = envelopeDecay(context.msWeight, io_pBuffer->uValidFrames);
+    for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+    {
+        for (AkUInt32 i = 0; i < AkMin(uNumChannels, 2); ++i)
+        {
+            msDecay[i] = decay[point];
+            for (AkUInt16 key = 0; key < kNumKeys; ++key)
+            {
+                instanceState->envelopeMS[point][key][i] -= startMS[key][i] * decay[point];
+            }
+        }
+    }
+    instanceState->envelopeFrames = io_pBuffer->uValidFrames;
+    g_SharedBuffer->addContribution(slot, instanceState->envelopeMS, msDecay);
+
+    finishTick(io_pBuffer->uValidFrames, context.refCount, context.percentile);
+}
+
+void AutoCompressorFX::finishTick(AkUInt16 frames, AkUInt16 refCount, AkReal32 percentile)
+{
+    // what AutoCompressorQuery reports for this instance
+    instanceState->priority = priority;
+    instanceState->numBands = static_cast<AkUInt8>(numBands);
+    instanceState->culled = (std::isnan(percentile) && !instanceState->virtualized) ? 1 : 0;
+
+    TraceRecorder& trace = TraceRecorder::get();
+    if (trace.isRecording())
+    {
+        traceInstance(trace, percentile);
+    }
+
+    // Monitor Data
+#ifndef AK_OPTIMIZED
+    if (m_pContext != nullptr && m_pContext->CanPostMonitorData())
+    {
+        // both lines back to back, each ending with its NUL, formatted on the stack so the audio thread doesn't allocate
+        char monitorData[64];
+        snprintf(monitorData, sizeof(monitorData) / 2, "%.2f, %.2f", AK_LINTODB(g_SharedBuffer->newbuffer_mRMS[0]), AK_LINTODB(g_SharedBuffer->newbuffer_mRMS[1]));
+        char* envelopeText = monitorData + strlen(monitorData) + 1;
+        snprintf(envelopeText, monitorData + sizeof(monitorData) - envelopeText, "%.2f, %.2f", instanceState->env_output[0][0], instanceState->env_output[0][1]);
+        m_pContext->PostMonitorData(monitorData, static_cast<AkUInt32>(envelopeText + strlen(envelopeText) + 1 - monitorData));
+    }
+#endif
+
+    const auto closeStart = std::chrono::steady_clock::now();
+    g_SharedBuffer->tickCostNs.fetch_add(static_cast<AkUInt32>(std::chrono::duration_cast<std::chrono::nanoseconds>(closeStart - executeStart).count()),
+        std::memory_order_relaxed);
+
+    // Once all plugin instances have submitted calculations, reset/update them
+    if (g_SharedBuffer->numBuffersCalculated.fetch_add(1, std::memory_order_acq_rel) + 1 >= refCount)
+    {
+        TIMELINE_SCOPE("close tick", group, slot, g_SharedBuffer->tickCount);
+        g_SharedBuffer->sumContributions();
+        g_SharedBuffer->calculateGovernor();
+        g_SharedBuffer->calculatemRMS();
+        g_SharedBuffer->calculateTruePeak();
+        g_SharedBuffer->calculateLeaveOneOut();
+        g_SharedBuffer->calculateCulling();
+        g_SharedBuffer->submitAnalysis();
+        g_SharedBuffer->applyAnalysis();
+        if (trace.isRecording())
+        {
+            traceBus(trace, frames);
+        }
+        g_SharedBuffer->tickCount++;
+        g_SharedBuffer->publishSnapshot();
+        g_SharedBuffer->resetSharedBuffer();
+        g_SharedBuffer->numBuffersCalculated.store(0, std::memory_order_relaxed);
+
+        // the tick close itself goes on the next tick's bill
+        g_SharedBuffer->tickCostNs.fetch_add(static_cast<AkUInt32>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - closeStart).count()), std::memory_order_relaxed);
+    }
+
+    m_pParams->m_paramChangeHandler.ResetAllParamChanges();
+}
+
+void AutoCompressorFX::processGain(const GainSettings& settings, AkUInt16 band, AkUInt16 channel, AkReal32* AK_RESTRICT pBuf, AkUInt16 firstFrame, AkUInt16 numFrames, AkUInt16 maxFrames)
+{
+    const AkReal32* sidechain = sidechainRMS[settings.key][channel];
+    const AkReal32 pointsPerFrame = static_cast<AkReal32>(kEnvelopePoints) / maxFrames;
+    AkReal32& keyMS = instanceState->myMS[settings.key][channel];
+    const AkUInt16 i = channel;
+    AkReal32 movingSBRMS = 0.0f;                                // the current mRMS of shared buffer, effectively the sidechain signal
+    AkReal32& gain = rampGain[band][i];
+    AkReal32& gainStep = rampIncrement[band][i];
+    if (firstFrame == 0)
+    {
+        // every ramp ends with its buffer, so the next one starts from the gain the envelope was left at whatever the tier
+        gain = Decibels::toLinear(instanceState->mixOutput[band][i]);
+        gainStep = 0.0f;
+    }
+
+    // the next envelope point this band's key reaches, multiband calls come a chunk at a time
+    AkUInt16 point = 0;
+    while (point < kEnvelopePoints && SharedBuffer::envelopeFrame(point + 1, maxFrames) <= firstFrame)
+    {
+        point++;
+    }
+    AkUInt16 pointFrame = (point < kEnvelopePoints) ? SharedBuffer::envelopeFrame(point + 1, maxFrames) : 0;
+
+    for (AkUInt16 offset = 0; offset < numFrames; ++offset)
+    {
+        const AkUInt16 frame = firstFrame + offset;
+
+        // Calculate myMS, same moving average as SharedBuffer::calculatemRMS but kept squared so it can be summed on the bus.
+        // It goes to the bus, so it stays per frame at every tier.
+        keyMS += (pBuf[offset] * pBuf[offset] - keyMS) * settings.msWeight;
+        while (frame + 1 == pointFrame)
+        {
+            instanceState->envelopeMS[point][settings.key][i] = keyMS;
+            point++;
+            pointFrame = (point < kEnvelopePoints) ? SharedBuffer::envelopeFrame(point + 1, maxFrames) : 0;
+        }
+
+        if (settings.step > 1)
+        {
+            // Lower quality tiers run the detector, gain computer and envelope once per step, at the level the step ends on,
+            // and ramp the gain there linearly
+            if (frame % settings.step == 0)
+            {
+                const AkUInt16 stepFrames = static_cast<AkUInt16>(AkMin(settings.step, maxFrames - frame));
+                const AkReal32 position = (frame + stepFrames) * pointsPerFrame;
+                const AkUInt16 segment = AkMin(static_cast<AkUInt16>(position), static_cast<AkUInt16>(kEnvelopePoints - 1));
+                movingSBRMS = sidechain[segment] + ((position - segment) * (sidechain[segment + 1] - sidechain[segment]));
+                if (settings.hold)
                 {
-                    AkReal32 m = ((1 / realRatio) - 1) / (2 * kneeDB);
-                    y = x + (m * powf(x - (thresholdDB - (kneeDB / 2)), 2));
+                    movingSBRMS = holdLevel(band, i, movingSBRMS, stepFrames);
                 }
-                
-                gainDB[i] = y - x;
 
-                // Apply Envelope
-                // note: ADSR values are never 0, using epsilon as minimum
-                // Formula found here: https://www.earlevel.com/main/2013/06/03/envelope-generators-adsr-code/
+                const bool wholeStep = stepFrames == settings.step;
+                stepEnvelope(settings, band, i, gainCurve[band].gainDB(Decibels::fromLinear(movingSBRMS)),
+                    wholeStep ? settings.attackStep : powf(settings.attackRate, stepFrames),
+                    wholeStep ? settings.releaseStep : powf(settings.releaseRate, stepFrames));
+                gainStep = (Decibels::toLinear(instanceState->mixOutput[band][i]) - gain) / stepFrames;
+            }
+            gain += gainStep;
+            pBuf[offset] *= gain;
+            continue;
+        }
+
+        // Determine the RMS of sidechain signal (movingSBRMS), using data from the previous buffer tick:
+        // the same point of that tick, interpolated between the envelope points of the bus
+        {
+            const AkReal32 position = (frame + 1) * pointsPerFrame;
+            const AkUInt16 segment = AkMin(static_cast<AkUInt16>(position), static_cast<AkUInt16>(kEnvelopePoints - 1));
+            movingSBRMS = sidechain[segment] + ((position - segment) * (sidechain[segment + 1] - sidechain[segment]));
+        }
+        if (settings.hold)
+        {
+            movingSBRMS = holdLevel(band, i, movingSBRMS, 1);
+        }
+
+        AkReal32 inputDB = Decibels::fromLinear(movingSBRMS); // in case the first buffer is loud enough to trigger compressor
+
+        // DSP section
+        {
+            // Calculate Compression DSP in DB, from the tabulated static curve (see GainCurve::analyticGainDB)
+            AkReal32 gainDB = gainCurve[band].gainDB(inputDB);
+
+            // Apply Envelope
+            stepEnvelope(settings, band, i, gainDB, settings.attackRate, settings.releaseRate);
+
+            // Execute DSP in linear
+            pBuf[offset] *= Decibels::toLinear(instanceState->mixOutput[band][i]);     // clamped to [0, 1] like before
+        }
+    }
+}
+
+void AutoCompressorFX::stepEnvelope(const GainSettings& settings, AkUInt16 band, AkUInt16 i, AkReal32 gainDB, AkReal32 attackRate, AkReal32 releaseRate)
+{
+    const AkReal32& overshootA = settings.overshootA;
+    const AkReal32& overshootR = settings.overshootR;
+    AkUInt8& state = instanceState->env_state[band];
+
+    // note: ADSR values are never 0, using epsilon as minimum
+    // Formula found here: https://www.earlevel.com/main/2013/06/03/envelope-generators-adsr-code/
+    instanceState->env_target[band][i] = -1 * gainDB;
+    AkReal32 rate;
+    if (instanceState->env_target[band][i] > instanceState->env_output[band][i])
+    {
+        state = env_attack;
+    }
+    else if (state != env_idle)
+    {
+        state = env_release;
+    }
+
+    switch (state)
+    {
+    case env_idle:
+        break;
+    case env_attack:
+        rate = attackRate;
+        instanceState->env_ratio[band][i] = static_cast<AkReal32>((instanceState->env_ratio[band][i] * rate) + ((1.0 + overshootA) * (1.0 - rate)));
+        instanceState->env_output[band][i] = instanceState->env_ratio[band][i] * instanceState->env_target[band][i];
+        instanceState->env_outputPeak[band][i] = instanceState->env_output[band][i];
+        if (instanceState->env_ratio[band][i] >= 1.0)
+        {
+            instanceState->env_ratio[band][i] = 1.0;
+            state = env_sustain;
+        }
+        break;
+    case env_sustain:
+        break;
+    case env_release:
+        rate = releaseRate;
+        instanceState->env_ratio[band][i] = static_cast<AkReal32>((instanceState->env_ratio[band][i] * rate) + ((-overshootR) * (1.0 - rate)));
+        instanceState->env_output[band][i] = instanceState->env_ratio[band][i] * instanceState->env_outputPeak[band][i];
+        if (instanceState->env_ratio[band][i] < 0.0)
+        {
+            instanceState->env_ratio[band][i] = 0.0;
+            state = env_idle;
+        }
+    }
+
+    instanceState->mixOutput[band][i] = -instanceState->env_output[band][i];
+}
+
+AkReal32 AutoCompressorFX::holdLevel(AkUInt16 band, AkUInt16 i, AkReal32 rms, AkUInt16 frames)
+{
+    // the window slides a block at a time, the block being filled counts as soon as it starts so an onset is never held back
+    AkReal32& blockPeak = holdBlockPeak[band][i];
+    AkUInt16& fill = holdBlockFill[band][i];
+    blockPeak = AkMax(blockPeak, rms);
+    const AkReal32 held = AkMax(holdMax[band][i].max(), blockPeak);
+
+    fill += frames;
+    if (fill >= kHoldBlockFrames)
+    {
+        // a step of the block quality tier can span more than one block
+        for (; fill >= kHoldBlockFrames; fill -= kHoldBlockFrames)
+        {
+            holdMax[band][i].push(blockPeak);
+        }
+        blockPeak = 0.0f;
+    }
+    return held;
+}
+
+void AutoCompressorFX::resetHold()
+{
+    for (AkUInt16 band = 0; band < kMaxBands; ++band)
+    {
+        holdMax[band][0].reset();
+        holdMax[band][1].reset();
+    }
+    std::fill(&holdBlockPeak[0][0], &holdBlockPeak[0][0] + (kMaxBands * 2), 0.0f);
+    std::fill(&holdBlockFill[0][0], &holdBlockFill[0][0] + (kMaxBands * 2), static_cast<AkUInt16>(0));
+}
+
+void AutoCompressorFX::processBands(AkAudioBuffer* io_pBuffer, const GainSettings settings[kMaxBands])
+{
+    const AkUInt16 uNumChannels = static_cast<AkUInt16>(AkMin(io_pBuffer->NumChannels(), 2));
+    const AkUInt16 uValidFrames = io_pBuffer->uValidFrames;
+    AkReal32* pBuf[2] = { io_pBuffer->GetChannel(0), io_pBuffer->GetChannel(uNumChannels - 1) };
+    AkReal32* bands[kMaxBands][2];
+    for (AkUInt16 band = 0; band < kMaxBands; ++band)
+    {
+        bands[band][0] = bandScratch[band][0];
+        bands[band][1] = bandScratch[band][1];
+    }
+
+    for (AkUInt16 chunkStart = 0; chunkStart < uValidFrames; chunkStart += kChunkFrames)
+    {
+        const AkUInt16 chunkFrames = static_cast<AkUInt16>(AkMin(kChunkFrames, uValidFrames - chunkStart));
+        const AkReal32* in[2] = { pBuf[0] + chunkStart, pBuf[1] + chunkStart };
+        crossover.process(in, uNumChannels, chunkFrames, bands);
+
+        for (AkUInt16 channel = 0; channel < uNumChannels; ++channel)
+        {
+            for (AkUInt16 band = 0; band < numBands; ++band)
+            {
+                processGain(settings[band], band, channel, bandScratch[band][channel], chunkStart, chunkFrames, uValidFrames);
+            }
+
+            // the bands sum back to the input, give or take the crossover's allpass
+            AkReal32* AK_RESTRICT out = pBuf[channel] + chunkStart;
+            for (AkUInt16 frame = 0; frame < chunkFrames; ++frame)
+            {
+                AkReal32 sum = 0.0f;
+                for (AkUInt16 band = 0; band < numBands; ++band)
                 {
-                    env_target[i] = -1 * gainDB[i];
-                    AkReal32 rate;
-                    if (env_target[i] > env_output[i])
-                    {
-                        env_state = env_attack;
-                    }
-                    else if (env_state != env_idle)
-                    {
-                        env_state = env_release;
-                    }
-
-                    switch (env_state)
-                    {
-                    case env_idle:
-                        break;
-                    case env_attack:
-                        rate = expf(-log((1 + overshootA) / overshootA) / (attack * sampleRate));
-                        env_ratio[i] = static_cast<AkReal32>((env_ratio[i] * rate) + ((1.0 + overshootA) * (1.0 - rate)));
-                        env_output[i] = env_ratio[i] * env_target[i];
-                        env_outputPeak[i] = env_output[i];
-                        if (env_ratio[i] >= 1.0)
-                        {
-                            env_ratio[i] = 1.0;
-                            env_state = env_sustain;
-                        }
-                        break;
-                    case env_sustain:
-                        break;
-                    case env_release:
-                        rate = expf(-log((1 + overshootR) / overshootR) / (release * sampleRate));
-                        env_ratio[i] = static_cast<AkReal32>((env_ratio[i] * rate) + ((-overshootR) * (1.0 - rate)));
-                        env_output[i] = env_ratio[i] * env_outputPeak[i];
-                        if (env_ratio[i] < 0.0)
-                        {
-                            env_ratio[i] = 0.0;
-                            env_state = env_idle;
-                        }
-                    }
-                    
+                    sum += bandScratch[band][channel][frame];
                 }
-                
-                // Find myRMS vs SBRMS %, in linear
-                scPercent[i] = (inputDB == 0) ? 1.0f : std::clamp(myRMS[i] / movingSBRMS[i], 0.0f, 1.0f);
-                
-
-                // Execute DSP in linear
-                mixOutput[i] = -env_output[i];
-                pBuf[uFramesProcessed] *= std::clamp(AK_DBTOLIN(mixOutput[i]), 0.0f, 1.0f);
+                out[frame] = sum;
             }
+        }
+    }
+}
+
+void AutoCompressorFX::updateLayout()
+{
+    const auto& paramChanges = m_pParams->m_paramChangeHandler;
 
+    // a move the new bus had no room for is tried again every tick, see joinGroup
+    bool groupChanged = m_pParams->NonRTPC.iGroup != group && joinGroup(m_pParams->NonRTPC.iGroup);
+    if (groupChanged || paramChanges.HasChanged(PARAM_CULL_BELOW_ID) || paramChanges.HasChanged(PARAM_CULL_KEEP_ID))
+    {
+        g_SharedBuffer->setCulling(m_pParams->NonRTPC.fCullBelow, m_pParams->NonRTPC.iCullKeep);
+    }
+    if (groupChanged || paramChanges.HasChanged(PARAM_TRUE_PEAK_ID))
+    {
+        g_SharedBuffer->setDetector(m_pParams->NonRTPC.bTruePeak);
+    }
+    if (groupChanged || paramChanges.HasChanged(PARAM_CPU_BUDGET_ID))
+    {
+        g_SharedBuffer->setBudget(m_pParams->NonRTPC.fCpuBudget);
+    }
+    if (paramChanges.HasChanged(PARAM_HOLD_ID))
+    {
+        const AkUInt32 holdBlocks = static_cast<AkUInt32>(ceilf(m_pParams->NonRTPC.fHold * sampleRate / kHoldBlockFrames));
+        for (AkUInt16 band = 0; band < kMaxBands; ++band)
+        {
+            holdMax[band][0].setWindow(holdBlocks);
+            holdMax[band][1].setWindow(holdBlocks);
+        }
+        resetHold();
+    }
 
-            ++uFramesProcessed;
+    bool crossoverChanged = paramChanges.HasChanged(PARAM_BANDS_ID);
+    for (AkPluginParamID crossoverID = PARAM_CROSSOVER1_ID; crossoverID < PARAM_CROSSOVER1_ID + kMaxBands - 1; ++crossoverID)
+    {
+        crossoverChanged = crossoverChanged || paramChanges.HasChanged(crossoverID);
+    }
+    if (!crossoverChanged)
+    {
+        return;
+    }
+
+    AkUInt16 bands = static_cast<AkUInt16>(std::clamp<AkInt32>(m_pParams->NonRTPC.iBands, 1, kMaxBands));
+    if (bands != numBands)
+    {
+        // start every band from silence rather than from another layout's state
+        crossover.reset();
+        std::fill(&instanceState->env_target[0][0], &instanceState->env_target[0][0] + (kMaxBands * 2), 0.0f);
+        std::fill(&instanceState->env_ratio[0][0], &instanceState->env_ratio[0][0] + (kMaxBands * 2), 0.0f);
+        std::fill(&instanceState->env_output[0][0], &instanceState->env_output[0][0] + (kMaxBands * 2), 0.0f);
+        std::fill(&instanceState->env_outputPeak[0][0], &instanceState->env_outputPeak[0][0] + (kMaxBands * 2), 0.0f);
+        std::fill(instanceState->env_state, instanceState->env_state + kMaxBands, static_cast<AkUInt8>(env_idle));
+        resetHold();
+        numBands = bands;
+    }
+    crossover.setup(numBands, m_pParams->NonRTPC.fCrossover, sampleRate);
+}
+
+bool AutoCompressorFX::joinGroup(AkInt32 newGroup)
+{
+    // from Execute the new bus can only take the instance with what Init set aside for it, GlobalManager::reserveForMoves
+    SharedBuffer* newBuffer = GlobalManager::getGlobalSharedBuffer(newGroup);
+    // the envelopes carry on from where they were, only the sidechain changes. The State goes in before the new bus can see the slot
+    AkUInt16 newSlot = (g_SharedBuffer == nullptr) ? newBuffer->registerInstance(sampleRate, maxFrames) : newBuffer->tryRegisterInstance(maxFrames, *instanceState);
+    if (newSlot == InstancePool::kNoSlot)
+    {
+        return false;
+    }
+    InstancePool::State* newState = newBuffer->getInstanceState(newSlot);
+    if (g_SharedBuffer != nullptr)
+    {
+        g_SharedBuffer->unregisterInstance(slot);
+    }
+
+    group = newGroup;
+    g_SharedBuffer = newBuffer;
+    slot = newSlot;
+    instanceState = newState;
+    instanceState->gameObject = gameObject;
+    instanceState->audioNode = objectID;
+    return true;
+}
+
+void AutoCompressorFX::processCulled(AkAudioBuffer* io_pBuffer, const AkReal32 channelMS[2], AkReal32 msWeight)
+{
+    const AkUInt16 uNumChannels = static_cast<AkUInt16>(AkMin(io_pBuffer->NumChannels(), 2));
+    const AkReal32 msDecay = powf(1.0f - msWeight, io_pBuffer->uValidFrames);
+
+    for (AkUInt16 i = 0; i < uNumChannels; ++i)
+    {
+        // the envelopes hold where they were, multiband gets the average of its bands so the crossover can be skipped too
+        AkReal32 gainDB = 0.0f;
+        for (AkUInt16 band = 0; band < numBands; ++band)
+        {
+            gainDB += instanceState->env_output[band][i];
+        }
+        const AkReal32 gain = Decibels::toLinear(-gainDB / numBands);
+        AkReal32* AK_RESTRICT pBuf = io_pBuffer->GetChannel(i);
+        for (AkUInt16 frame = 0; frame < io_pBuffer->uValidFrames; ++frame)
+        {
+            pBuf[frame] *= gain;
+        }
+
+        // myMS keeps following the signal in closed form, so the instance comes back to the bus at its real level
+        for (AkUInt16 key = 0; key < kNumKeys; ++key)
+        {
+            instanceState->myMS[key][i] *= msDecay;
         }
+        instanceState->myMS[SharedBuffer::kFullBandKey][i] += channelMS[i] * (1.0f - msDecay);
     }
-    
-    // Monitor Data
-#ifndef AK_OPTIMIZED
-    if (m_pContext->CanPostMonitorData())
+
+    // nothing of this tick reached the bus
+    std::fill(&instanceState->envelopeMS[0][0][0], &instanceState->envelopeMS[0][0][0] + (kEnvelopePoints * kNumKeys * 2), 0.0f);
+    instanceState->envelopeFrames = io_pBuffer->uValidFrames;
+}
+
+const AkReal32* AutoCompressorFX::envelopeDecay(AkReal32 msWeight, AkUInt16 frames)
+{
+    if (msWeight != pointDecayWeight || frames != pointDecayFrames)
+    {
+        for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+        {
+            pointDecay[point] = powf(1.0f - msWeight, SharedBuffer::envelopeFrame(point + 1, frames));
+        }
+        pointDecayWeight = msWeight;
+        pointDecayFrames = frames;
+    }
+    return pointDecay;
+}
+
+void AutoCompressorFX::buildSidechain(AkReal32 msWeight)
+{
+    // The bus published what every instance added to its moving mean square by each point of the last tick. Taking this
+    // instance's own share back out, on top of what was left of the others' since the tick before, gives its sidechain at each point.
+    const AkUInt16 frames = instanceState->envelopeFrames;
+    const AkReal32* decay = envelopeDecay(msWeight, frames);
+
+    // only the keys this instance's bands listen to
+    const AkUInt16 firstKey = (numBands > 1) ? SharedBuffer::kFullBandKey + 1 : SharedBuffer::kFullBandKey;
+    for (AkUInt16 key = firstKey; key < firstKey + numBands; ++key)
     {
-        std::ostringstream reformat1, reformat2, reformat3, reformat4;
-        reformat1 << std::fixed << std::setprecision(2) << AK_LINTODB(g_SharedBuffer->newbuffer_mRMS[0]);
-        reformat2 << std::fixed << std::setprecision(2) << AK_LINTODB(g_SharedBuffer->newbuffer_mRMS[1]);
-        reformat3 << std::fixed << std::setprecision(2) << env_output[0];
-        reformat4 << std::fixed << std::setprecision(2) << env_output[1];
-        std::stringstream sstream1, sstream2;
-        sstream1 << reformat1.str() << ", " << reformat2.str();
-        sstream2 << reformat3.str() << ", " << reformat4.str();
-        std::string monitorData[2] = { sstream1.str(), sstream2.str() };
-        m_pContext->PostMonitorData((void*)monitorData, sizeof(monitorData));
+        for (AkUInt16 i = 0; i < 2; ++i)
+        {
+            AkReal32* points = sidechainRMS[key][i];
+            const AkReal32 lastRMS = instanceState->lastKeyRMS[key][i];
+            const AkReal32 newRMS = instanceState->newKeyRMS[key][i];
+            points[0] = lastRMS;
+            for (AkUInt16 point = 1; point < kEnvelopePoints; ++point)
+            {
+                if (frames == 0)
+                {
+                    // a new instance has no share of its own to take out yet
+                    points[point] = lastRMS + ((newRMS - lastRMS) * point / kEnvelopePoints);
+                    continue;
+                }
+                const AkReal32 others = AkMax(g_SharedBuffer->envelopeMS[point - 1][key][i] - instanceState->envelopeMS[point - 1][key][i], 0.0f);
+                points[point] = sqrtf((lastRMS * lastRMS * decay[point - 1]) + others);
+            }
+            points[kEnvelopePoints] = newRMS;           // the bus worked that one out already, exactly
 
+            // with the true-peak detector, the others peak as far over their RMS as the whole group does
+            if (key == SharedBuffer::kFullBandKey)
+            {
+                for (AkUInt16 point = 0; point <= kEnvelopePoints; ++point)
+                {
+                    points[point] *= g_SharedBuffer->crestFactor[point][i];
+                }
+            }
+        }
     }
-#endif
+}
 
-    // Once all plugin instances have submitted calculations, reset/update them
-    if (g_SharedBuffer->numBuffersCalculated >= refCount)
+void AutoCompressorFX::traceInstance(TraceRecorder& trace, AkReal32 percentile)
+{
+    TraceRecord record = {};
+    record.kind = TraceRecord::kind_instance;
+    record.group = static_cast<AkUInt8>(group);
+    record.slot = slot;
+    record.tick = g_SharedBuffer->tickCount;
+    record.instance.priority = priority;
+    record.instance.percentile = percentile;        // NaN when culled or virtual
+    record.instance.numBands = static_cast<AkUInt8>(numBands);
+    record.instance.culled = instanceState->culled;
+    for (AkUInt16 band = 0; band < numBands; ++band)
     {
-        g_SharedBuffer->diff_mRMS[0] = rmsDiff[0];
-        g_SharedBuffer->diff_mRMS[1] = rmsDiff[1];
-        g_SharedBuffer->calculatemRMS(frames10ms);
-        g_SharedBuffer->calculatePriorityMinMax();
-        g_SharedBuffer->resetSharedBufferAndPriorityList();
-        g_SharedBuffer->numBuffersCalculated.store(0, std::memory_order_relaxed);
+        record.instance.gainReductionDB[band] = AkMax(instanceState->env_output[band][0], instanceState->env_output[band][1]);
+        record.instance.envState[band] = instanceState->env_state[band];
     }
+    trace.push(record);
+}
+
+void AutoCompressorFX::traceBus(TraceRecorder& trace, AkUInt16 frames)
+{
+    TraceRecord record = {};
+    record.kind = TraceRecord::kind_bus;
+    record.group = static_cast<AkUInt8>(group);
+    record.tick = g_SharedBuffer->tickCount;
+    record.bus.sidechainRMS[0] = g_SharedBuffer->newbuffer_mRMS[0];
+    record.bus.sidechainRMS[1] = g_SharedBuffer->newbuffer_mRMS[1];
+    record.bus.minPriority = g_SharedBuffer->minPriority;
+    record.bus.maxPriority = g_SharedBuffer->maxPriority;
+    record.bus.sampleRate = sampleRate;
+    record.bus.frames = frames;
+    record.bus.numInstances = g_SharedBuffer->numInstances;
+    record.bus.numCulled = g_SharedBuffer->numCulled;
+    trace.push(record);
 }
 
 AKRESULT AutoCompressorFX::TimeSkip(AkUInt32 in_uFrames)
 {
+    // A virtual voice is a silent tick sat out of the sidechain, like a culled one. It still counts towards its group's tick,
+    // which would otherwise close early or late for as long as the voice stays virtual, but not as culled: it stays out of
+    // numCulled and of the CullKeep ranking, which are about the voices the group can hear
+    TIMELINE_SCOPE("TimeSkip", group, slot, g_SharedBuffer->tickCount);
+    executeStart = std::chrono::steady_clock::now();
+    updateLayout();
+    const AkUInt16 refCount = g_SharedBuffer->numInstances;
+    const AkUInt16 frames = static_cast<AkUInt16>(AkMin(in_uFrames, 0xFFFFu));
+
+    // the envelopes hold where they were and myMS fades over the silence, see processCulled
+    const AkReal32 msWeight = 1.0f / ((sampleRate / 100) * AkMax(numChannels, 1u));
+    const AkReal32 msDecay = powf(1.0f - msWeight, frames);
+    for (AkUInt16 key = 0; key < kNumKeys; ++key)
+    {
+        instanceState->myMS[key][0] *= msDecay;
+        instanceState->myMS[key][1] *= msDecay;
+    }
+    instanceState->blockMS = 0.0f;
+    instanceState->virtualized = 1;
+    std::fill(&instanceState->envelopeMS[0][0][0], &instanceState->envelopeMS[0][0][0] + (kEnvelopePoints * kNumKeys * 2), 0.0f);
+    instanceState->envelopeFrames = frames;
+
+    finishTick(frames, refCount, NAN);
     return AK_DataReady;
 }
 
@@ -29,6 +29,10 @@ the specific language governing permissions and limitations under the License.
 
 #include "AutoCompressorFXParams.h"
 #include "SharedBuffer.h"
+#include "Crossover.h"
+#include "GainCurve.h"
+#include "SlidingMax.h"
+#include "TraceRecorder.h"
 #include <vector>
 #include <cmath>
 #include <string>
@@ -36,6 +40,7 @@ the specific language governing permissions and limitations under the License.
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <chrono>
 
 /// See https://www.audiokinetic.com/library/edge/?source=SDK&id=soundengine__plugins__effects.html
 /// for the documentation about effect plug-ins
@@ -65,30 +70,126 @@ public:
     void Execute(AkAudioBuffer* io_pBuffer) override;
 
     /// Skips execution of some frames, when the voice is virtual playing from elapsed time.
-    /// This can be used to simulate processing that would have taken place (e.g. update internal state).
+    /// The instance sits the tick out like a culled one, holding its gain, but its group's tick still counts it.
     /// Return AK_DataReady or AK_NoMoreData, depending if there would be audio output or not at that point.
     AKRESULT TimeSkip(AkUInt32 in_uFrames) override;
 
+    /// Executes several instances for one tick, like calling Execute on each in turn, for hosts that run many voices in lockstep
+    /// (the offline renderer, the stand-in host). Full band instances at full quality with the same buffer length and channels
+    /// go through the gain computer and envelope kLanes at a time, one instance per SIMD lane, the others one at a time.
+    /// An instance must not appear twice, and ticks still close in the order the instances are given.
+    static void ExecuteBatch(AutoCompressorFX* const* in_ppInstances, AkAudioBuffer* const* io_ppBuffers, AkUInt16 in_uNumInstances);
+
+    static constexpr AkUInt16 kLanes = 4;   // instances per AKSIMD_V4F32
     
 
 private:
+    static constexpr AkUInt16 kMaxBands = Crossover::kMaxBands;
+    static constexpr AkUInt16 kNumKeys = SharedBuffer::kNumKeys;
+    static constexpr AkUInt16 kChunkFrames = 64;   // multiband mode splits the buffer this many frames at a time
+    static constexpr AkUInt16 kEnvelopePoints = SharedBuffer::kEnvelopePoints;
+    static constexpr AkUInt16 kSubBlockFrames = 16; // how often the sub-block quality tier runs the gain computer, see SharedBuffer::calculateGovernor
+    static constexpr AkUInt16 kHoldBlockFrames = 64; // resolution of the hold window, SlidingMax::kCapacity blocks of it is over 0.6 s up to 96 kHz
+
+    // Everything the gain computer of one band needs, worked out once per Execute
+    struct GainSettings
+    {
+        AkUInt16 key;               // which sidechain key of SharedBuffer drives this band
+        AkReal32 thresholdDB;
+        AkReal32 kneeDB;
+        AkReal32 realRatio;
+        AkReal32 attackRate;        // per-frame coefficients of the envelope
+        AkReal32 releaseRate;
+        AkReal32 overshootA;
+        AkReal32 overshootR;
+        AkReal32 msWeight;          // weight of one new square in the moving mean square
+        AkUInt16 step;              // frames per gain computer update, 1 at full quality
+        AkReal32 attackStep;        // attackRate and releaseRate over a whole step
+        AkReal32 releaseStep;
+        bool hold;                  // the gain computer sees the loudest sidechain level of the hold window rather than the current one
+    };
+
+    // What Execute works out before the gain stage and still needs after it, so ExecuteBatch can run the gain stage of
+    // several instances together in between
+    struct TickContext
+    {
+        AkUInt16 refCount;
+        AkReal32 msWeight;
+        AkReal32 startMS[kNumKeys][2];      // myMS when the tick started
+        AkReal32 percentile;                // NaN when the instance sits this tick out
+        GainSettings settings[kMaxBands];
+    };
+
+    /// Everything up to the gain stage: parameters, culling, the contribution to the bus and the sidechain. False when culled,
+    /// the held gain was applied already and there is no gain stage to run.
+    bool beginTick(AkAudioBuffer* io_pBuffer, TickContext& context);
+
+    /// The gain stage of every channel and band, one instance at a time.
+    void processTick(AkAudioBuffer* io_pBuffer, const TickContext& context);
+
+    /// The gain stage of kLanes full band instances at full quality with the same buffer geometry, one instance per SIMD lane.
+    static void processTickLanes(AutoCompressorFX* const lanes[kLanes], AkAudioBuffer* const buffers[kLanes], const TickContext* const contexts[kLanes]);
+
+    /// What this tick added to the bus by each envelope point, and finishTick.
+    void endTick(AkAudioBuffer* io_pBuffer, const TickContext& context);
+
+    /// Works out this instance's leave-one-out sidechain at every envelope point of the last tick, into sidechainRMS.
+    void buildSidechain(AkReal32 msWeight);
+
+    /// How much of the moving mean square survives from the start of a tick of the given length to each of its envelope points.
+    const AkReal32* envelopeDecay(AkReal32 msWeight, AkUInt16 frames);
+
+    /// Runs the sidechain follower, gain computer and envelope of one band of one channel, in place.
+    void processGain(const GainSettings& settings, AkUInt16 band, AkUInt16 channel, AkReal32* AK_RESTRICT pBuf, AkUInt16 firstFrame, AkUInt16 numFrames, AkUInt16 maxFrames);
+
+    /// Moves the envelope of one band of one channel towards gainDB, by one frame or by a whole step with the rates raised to its length.
+    void stepEnvelope(const GainSettings& settings, AkUInt16 band, AkUInt16 i, AkReal32 gainDB, AkReal32 attackRate, AkReal32 releaseRate);
+
+    /// Feeds frames frames at the sidechain level rms to the hold of one band of one channel, and returns the loudest level of its window.
+    AkReal32 holdLevel(AkUInt16 band, AkUInt16 i, AkReal32 rms, AkUInt16 frames);
+
+    /// Empties the hold windows, so a new hold time or band layout doesn't start from levels it never saw.
+    void resetHold();
+
+    /// Splits the buffer with the crossover, compresses every band on its own and sums them back.
+    void processBands(AkAudioBuffer* io_pBuffer, const GainSettings settings[kMaxBands]);
+
+    /// Applies the held envelope gain without touching the bus, for a tick where this instance is culled.
+    void processCulled(AkAudioBuffer* io_pBuffer, const AkReal32 channelMS[2], AkReal32 msWeight);
+
+    /// Monitor data and trace records, and the tick close once every instance of the group has run.
+    /// percentile is NaN on a tick where this instance was culled or virtual.
+    void finishTick(AkUInt16 frames, AkUInt16 refCount, AkReal32 percentile);
+
+    /// Trace records of this instance and, from the instance closing the tick, of its bus.
+    void traceInstance(TraceRecorder& trace, AkReal32 percentile);
+    void traceBus(TraceRecorder& trace, AkUInt16 frames);
+
+    /// Picks up changes to the non-RTPC parameters (group, band layout, culling, detectors and CPU budget).
+    void updateLayout();
+
+    /// Moves this instance to the bus of newGroup, taking its DSP state along. Init calls it with no bus yet.
+    /// False when the new bus has no room for it without allocating, the instance stays where it was.
+    bool joinGroup(AkInt32 newGroup);
+
     AutoCompressorFXParams* m_pParams;
     AK::IAkPluginMemAlloc* m_pAllocator;
     AK::IAkEffectPluginContext* m_pContext;
 
-    std::shared_ptr<SharedBuffer> g_SharedBuffer = GlobalManager::getGlobalSharedBuffer();
-    
-    AkReal32 myRMS[2] = { 0.0f, 0.0f };             // in linear
+    SharedBuffer* g_SharedBuffer = nullptr;             // the bus of this instance's group, busses are never destroyed
+    InstancePool::State* instanceState = nullptr;       // envelopes and sidechain levels, in the bus's pool next to the slot they go with
+
     AkUniqueID objectID = 0;
+    AkGameObjectID gameObject = AK_INVALID_GAME_OBJECT;
+    AkInt32 group = 0;
+    AkUInt16 slot = 0;                                  // this instance's slot in g_SharedBuffer
+    AkUInt16 numBands = 1;
     AkUInt32 sampleRate;
+    AkUInt32 numChannels = 2;
+    AkUInt16 maxFrames = GlobalManager::kDefaultMaxBufferLength;   // the longest buffer the sound engine hands this instance
     AkReal32 epsilon = static_cast<AkReal32>(powf(10,-6));
     AkReal32 priority = 1.0f;               
-    AkReal32 env_target[2] = { 0.0f, 0.0f };        // target gain (w/o envelope), but positive
-    AkReal32 env_ratio[2] = { 0.0f, 0.0f };         // ratio of dry signal affected by envelope, between 0 & 1
-    AkReal32 env_output[2] = { 0.0f, 0.0f };        // output based on env_ratio, in dB
-    AkReal32 env_outputPeak[2] = { 0.0f, 0.0f };    
-    AkReal32 scPercent[2] = { 0.0f, 0.0f };         // this plugin's percent of the sidechain signal
-    AkReal32 mixOutput[2] = { 0.0f, 0.0f };
+    std::chrono::steady_clock::time_point executeStart;
 
     enum envState
     {
@@ -97,10 +198,19 @@ private:
         env_sustain,
         env_release
     };
-    AkUInt16 env_state = env_idle;
 
-    // Debugging
-    std::string errorMsg;
+    Crossover crossover;
+    GainCurve gainCurve[kMaxBands];                     // static curve of each band, rebuilt when its threshold, knee or ratio moves
+    AkReal32 bandScratch[kMaxBands][2][kChunkFrames];
+    AkReal32 sidechainRMS[kNumKeys][2][kEnvelopePoints + 1];   // the last tick's sidechain, from its start to each of its points, played back one tick late
+    AkReal32 pointDecay[kEnvelopePoints];                      // envelopeDecay() for the weight and length below, which rarely change
+    AkReal32 pointDecayWeight = 0.0f;
+    AkUInt16 pointDecayFrames = 0;
+    AkReal32 rampGain[kMaxBands][2] = {};                       // linear gain the lower quality tiers ramp from, and by how much per frame
+    AkReal32 rampIncrement[kMaxBands][2] = {};
+    SlidingMax holdMax[kMaxBands][2];                           // the loudest sidechain level of each finished block of the hold window
+    AkReal32 holdBlockPeak[kMaxBands][2] = {};                  // and of the block being filled
+    AkUInt16 holdBlockFill[kMaxBands][2] = {};
 };
 
 
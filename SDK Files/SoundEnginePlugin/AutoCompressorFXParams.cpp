@@ -59,6 +59,24 @@ AKRESULT AutoCompressorFXParams::Init(AK::IAkPluginMemAlloc* in_pAllocator, cons
         RTPC.fKnee = 0.0f;
         RTPC.fAttack = 0.0f;
         RTPC.fRelease = 0.0f;
+        NonRTPC.iGroup = 0;
+        NonRTPC.iBands = 1;
+        NonRTPC.fCrossover[0] = 250.0f;
+        NonRTPC.fCrossover[1] = 2000.0f;
+        NonRTPC.fCrossover[2] = 6000.0f;
+        NonRTPC.bAutoThreshold = false;
+        NonRTPC.fAutoPercentile = 50.0f;
+        NonRTPC.fAutoHorizon = 30.0f;
+        NonRTPC.fCullBelow = -120.0f;
+        NonRTPC.iCullKeep = 0;
+        NonRTPC.bTruePeak = false;
+        NonRTPC.fCpuBudget = 0.0f;
+        NonRTPC.fHold = 0.0f;
+        for (AkUInt32 band = 0; band < MAX_BANDS; ++band)
+        {
+            RTPC.fBandThreshold[band] = 0.0f;
+            RTPC.fBandRatio[band] = 1.0f;
+        }
         m_paramChangeHandler.SetAllParamChanges();
         return AK_Success;
     }
@@ -84,6 +102,28 @@ AKRESULT AutoCompressorFXParams::SetParamsBlock(const void* in_pParamsBlock, AkU
     RTPC.fKnee = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fAttack = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fRelease = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iGroup = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iBands = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    for (AkUInt32 crossover = 0; crossover < MAX_BANDS - 1; ++crossover)
+    {
+        NonRTPC.fCrossover[crossover] = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    }
+    for (AkUInt32 band = 0; band < MAX_BANDS; ++band)
+    {
+        RTPC.fBandThreshold[band] = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    }
+    for (AkUInt32 band = 0; band < MAX_BANDS; ++band)
+    {
+        RTPC.fBandRatio[band] = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    }
+    NonRTPC.bAutoThreshold = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fAutoPercentile = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fAutoHorizon = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCullBelow = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iCullKeep = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.bTruePeak = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCpuBudget = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fHold = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     CHECKBANKDATASIZE(in_ulBlockSize, eResult);
     m_paramChangeHandler.SetAllParamChanges();
 
@@ -121,6 +161,66 @@ AKRESULT AutoCompressorFXParams::SetParam(AkPluginParamID in_paramID, const void
         RTPC.fRelease = *((AkReal32*)in_pValue);
         m_paramChangeHandler.SetParamChange(PARAM_RELEASE_ID);
         break;
+    case PARAM_GROUP_ID:
+        NonRTPC.iGroup = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_GROUP_ID);
+        break;
+    case PARAM_BANDS_ID:
+        NonRTPC.iBands = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_BANDS_ID);
+        break;
+    case PARAM_CROSSOVER1_ID:
+    case PARAM_CROSSOVER1_ID + 1:
+    case PARAM_CROSSOVER1_ID + 2:
+        NonRTPC.fCrossover[in_paramID - PARAM_CROSSOVER1_ID] = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(in_paramID);
+        break;
+    case PARAM_BAND1_THRESHOLD_ID:
+    case PARAM_BAND1_THRESHOLD_ID + 1:
+    case PARAM_BAND1_THRESHOLD_ID + 2:
+    case PARAM_BAND1_THRESHOLD_ID + 3:
+        RTPC.fBandThreshold[in_paramID - PARAM_BAND1_THRESHOLD_ID] = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(in_paramID);
+        break;
+    case PARAM_BAND1_RATIO_ID:
+    case PARAM_BAND1_RATIO_ID + 1:
+    case PARAM_BAND1_RATIO_ID + 2:
+    case PARAM_BAND1_RATIO_ID + 3:
+        RTPC.fBandRatio[in_paramID - PARAM_BAND1_RATIO_ID] = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(in_paramID);
+        break;
+    case PARAM_AUTO_THRESHOLD_ID:
+        NonRTPC.bAutoThreshold = *((bool*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_AUTO_THRESHOLD_ID);
+        break;
+    case PARAM_AUTO_PERCENTILE_ID:
+        NonRTPC.fAutoPercentile = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_AUTO_PERCENTILE_ID);
+        break;
+    case PARAM_AUTO_HORIZON_ID:
+        NonRTPC.fAutoHorizon = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_AUTO_HORIZON_ID);
+        break;
+    case PARAM_CULL_BELOW_ID:
+        NonRTPC.fCullBelow = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CULL_BELOW_ID);
+        break;
+    case PARAM_CULL_KEEP_ID:
+        NonRTPC.iCullKeep = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CULL_KEEP_ID);
+        break;
+    case PARAM_TRUE_PEAK_ID:
+        NonRTPC.bTruePeak = *((bool*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_TRUE_PEAK_ID);
+        break;
+    case PARAM_CPU_BUDGET_ID:
+        NonRTPC.fCpuBudget = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CPU_BUDGET_ID);
+        break;
+    case PARAM_HOLD_ID:
+        NonRTPC.fHold = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_HOLD_ID);
+        break;
     default:
         eResult = AK_InvalidParameter;
         break;
@@ -38,7 +38,23 @@ static const AkPluginParamID PARAM_RATIO_ID = 2;
 static const AkPluginParamID PARAM_KNEE_ID = 3;
 static const AkPluginParamID PARAM_ATTACK_ID = 4;
 static const AkPluginParamID PARAM_RELEASE_ID = 5;
-static const AkUInt32 NUM_PARAMS = 6;
+static const AkPluginParamID PARAM_GROUP_ID = 6;
+static const AkPluginParamID PARAM_BANDS_ID = 7;
+static const AkPluginParamID PARAM_CROSSOVER1_ID = 8;            // Crossover2 and Crossover3 follow
+static const AkPluginParamID PARAM_BAND1_THRESHOLD_ID = 11;      // one per band, up to MAX_BANDS
+static const AkPluginParamID PARAM_BAND1_RATIO_ID = 15;          // one per band, up to MAX_BANDS
+static const AkPluginParamID PARAM_AUTO_THRESHOLD_ID = 19;
+static const AkPluginParamID PARAM_AUTO_PERCENTILE_ID = 20;
+static const AkPluginParamID PARAM_AUTO_HORIZON_ID = 21;
+static const AkPluginParamID PARAM_CULL_BELOW_ID = 22;
+static const AkPluginParamID PARAM_CULL_KEEP_ID = 23;
+static const AkPluginParamID PARAM_TRUE_PEAK_ID = 24;
+static const AkPluginParamID PARAM_CPU_BUDGET_ID = 25;
+static const AkPluginParamID PARAM_HOLD_ID = 26;
+static const AkUInt32 NUM_PARAMS = 27;
+
+static const AkUInt32 MAX_BANDS = 4;
+static const AkUInt32 NUM_GROUPS = 16;
 
 struct AutoCompressorRTPCParams
 {
@@ -48,10 +64,23 @@ struct AutoCompressorRTPCParams
     AkReal32 fKnee;
     AkReal32 fAttack;
     AkReal32 fRelease;
+    AkReal32 fBandThreshold[MAX_BANDS];     // replace fThreshold and fRatio when iBands > 1
+    AkReal32 fBandRatio[MAX_BANDS];
 };
 
 struct AutoCompressorNonRTPCParams
 {
+    AkInt32 iGroup;                         // which sidechain bus the instance ducks on
+    AkInt32 iBands;                         // 1 is full band
+    AkReal32 fCrossover[MAX_BANDS - 1];     // in Hz, ascending
+    bool bAutoThreshold;                    // thresholds follow a percentile of the group's level instead of fThreshold/fBandThreshold
+    AkReal32 fAutoPercentile;               // 0 to 100
+    AkReal32 fAutoHorizon;                  // in seconds, how far back the percentile remembers
+    AkReal32 fCullBelow;                    // in dB under the group's level, quieter instances skip the sidechain, -120 is off
+    AkInt32 iCullKeep;                      // only the loudest this many instances of the group take part, 0 is off
+    bool bTruePeak;                         // the group's full band sidechain follows its true peak instead of its RMS
+    AkReal32 fCpuBudget;                    // in microseconds per tick for the whole group, over it the gain computers run less often, 0 is off
+    AkReal32 fHold;                         // in seconds, the sidechain is held at its loudest over this window so it doesn't release between syllables, 0 is off
 };
 
 struct AutoCompressorFXParams
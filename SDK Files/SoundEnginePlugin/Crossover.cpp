@@ -0,0 +1,238 @@
+#include "Crossover.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	enum FilterType
+	{
+		filter_lowpass = 0,
+		filter_highpass,
+		filter_allpass
+	};
+
+	// RBJ cookbook biquads at Q = 1/sqrt(2). Two Butterworth low-passes (or high-passes) in a row make an LR4,
+	// and an LR4 low-pass plus its high-pass equals the allpass below, which is what keeps the bands phase aligned.
+	void designBiquad(FilterType type, AkReal32 frequency, AkUInt32 sampleRate, AkReal32 out[5])
+	{
+		const double w0 = 2.0 * 3.14159265358979323846 * frequency / sampleRate;
+		const double cosw0 = cos(w0);
+		const double alpha = sin(w0) / (2.0 * 0.70710678118654752440);
+		const double a0 = 1.0 + alpha;
+		double b0, b1, b2;
+
+		switch (type)
+		{
+		case filter_lowpass:
+			b0 = (1.0 - cosw0) / 2.0;
+			b1 = 1.0 - cosw0;
+			b2 = b0;
+			break;
+		case filter_highpass:
+			b0 = (1.0 + cosw0) / 2.0;
+			b1 = -(1.0 + cosw0);
+			b2 = b0;
+			break;
+		default:
+			b0 = 1.0 - alpha;
+			b1 = -2.0 * cosw0;
+			b2 = 1.0 + alpha;
+			break;
+		}
+
+		out[0] = static_cast<AkReal32>(b0 / a0);
+		out[1] = static_cast<AkReal32>(b1 / a0);
+		out[2] = static_cast<AkReal32>(b2 / a0);
+		out[3] = static_cast<AkReal32>((-2.0 * cosw0) / a0);
+		out[4] = static_cast<AkReal32>((1.0 - alpha) / a0);
+	}
+
+	struct BiquadLanes
+	{
+		AKSIMD_V4F32 b0, b1, b2, a1, a2;
+		AKSIMD_V4F32 z1, z2;
+	};
+
+	inline AKSIMD_V4F32 tick(BiquadLanes& bq, AKSIMD_V4F32 x)
+	{
+		AKSIMD_V4F32 y = AKSIMD_MADD_V4F32(bq.b0, x, bq.z1);
+		bq.z1 = AKSIMD_SUB_V4F32(AKSIMD_MADD_V4F32(bq.b1, x, bq.z2), AKSIMD_MUL_V4F32(bq.a1, y));
+		bq.z2 = AKSIMD_SUB_V4F32(AKSIMD_MUL_V4F32(bq.b2, x), AKSIMD_MUL_V4F32(bq.a2, y));
+		return y;
+	}
+}
+
+void Crossover::setup(AkUInt16 in_numBands, const AkReal32 frequencies[kMaxBands - 1], AkUInt32 sampleRate)
+{
+	numBands = std::clamp<AkUInt16>(in_numBands, 1, kMaxBands);
+
+	// Crossovers have to stay ascending and below Nyquist
+	AkReal32 freq[kMaxBands - 1];
+	AkReal32 lowest = 20.0f;
+	const AkReal32 highest = 0.45f * sampleRate;
+	for (AkUInt16 i = 0; i < kMaxBands - 1; ++i)
+	{
+		freq[i] = std::clamp(frequencies[i], lowest, highest);
+		lowest = freq[i];
+	}
+
+	const AkReal32 passthrough[numCoefficients] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (AkUInt16 section = 0; section < numSections; ++section)
+	{
+		for (AkUInt16 lane = 0; lane < 4; ++lane)
+		{
+			setLane(static_cast<Section>(section), lane, passthrough);
+		}
+	}
+
+	AkReal32 lowpass[numCoefficients], highpass[numCoefficients], allpass[kMaxBands - 1][numCoefficients];
+	for (AkUInt16 i = 0; i < numBands - 1; ++i)
+	{
+		designBiquad(filter_lowpass, freq[i], sampleRate, lowpass);
+		designBiquad(filter_highpass, freq[i], sampleRate, highpass);
+		designBiquad(filter_allpass, freq[i], sampleRate, allpass[i]);
+
+		const Section first = static_cast<Section>(split1_a + (2 * i));
+		const Section second = static_cast<Section>(split1_b + (2 * i));
+		for (AkUInt16 lane = 0; lane < 2; ++lane)
+		{
+			setLane(first, lane, lowpass);
+			setLane(second, lane, lowpass);
+			setLane(first, lane + 2, highpass);
+			setLane(second, lane + 2, highpass);
+		}
+	}
+
+	for (AkUInt16 lane = 0; lane < 2; ++lane)
+	{
+		if (numBands >= 3)
+		{
+			setLane(allpass_a, lane, allpass[1]);
+		}
+		if (numBands == 4)
+		{
+			setLane(allpass_a, lane + 2, allpass[2]);
+			setLane(allpass_b, lane, allpass[2]);
+		}
+	}
+}
+
+void Crossover::reset()
+{
+	std::fill(&state[0][0][0], &state[0][0][0] + (numSections * 2 * 4), 0.0f);
+}
+
+void Crossover::setLane(Section section, AkUInt16 lane, const AkReal32 in_coefficients[numCoefficients])
+{
+	for (AkUInt16 coefficient = 0; coefficient < numCoefficients; ++coefficient)
+	{
+		coefficients[section][coefficient][lane] = in_coefficients[coefficient];
+	}
+}
+
+void Crossover::process(const AkReal32* const in[2], AkUInt16 numChannels, AkUInt32 numFrames, AkReal32* const out[kMaxBands][2])
+{
+	switch (numBands)
+	{
+	case 2:
+		processBands<2>(in, numChannels, numFrames, out);
+		break;
+	case 3:
+		processBands<3>(in, numChannels, numFrames, out);
+		break;
+	case 4:
+		processBands<4>(in, numChannels, numFrames, out);
+		break;
+	default:
+		for (AkUInt16 channel = 0; channel < numChannels; ++channel)
+		{
+			std::copy(in[channel], in[channel] + numFrames, out[0][channel]);
+		}
+		break;
+	}
+}
+
+template <AkUInt16 NumBands>
+void Crossover::processBands(const AkReal32* const in[2], AkUInt16 numChannels, AkUInt32 numFrames, AkReal32* const out[kMaxBands][2])
+{
+	// 2 bands only need the first crossover
+	constexpr AkUInt16 usedSections = (NumBands == 2) ? split2_a : numSections;
+
+	BiquadLanes lanes[numSections];
+	for (AkUInt16 section = 0; section < usedSections; ++section)
+	{
+		BiquadLanes& bq = lanes[section];
+		bq.b0 = AKSIMD_LOAD_V4F32(coefficients[section][coef_b0]);
+		bq.b1 = AKSIMD_LOAD_V4F32(coefficients[section][coef_b1]);
+		bq.b2 = AKSIMD_LOAD_V4F32(coefficients[section][coef_b2]);
+		bq.a1 = AKSIMD_LOAD_V4F32(coefficients[section][coef_a1]);
+		bq.a2 = AKSIMD_LOAD_V4F32(coefficients[section][coef_a2]);
+		bq.z1 = AKSIMD_LOAD_V4F32(state[section][0]);
+		bq.z2 = AKSIMD_LOAD_V4F32(state[section][1]);
+	}
+
+	const bool stereo = numChannels > 1;
+	AkReal32 frame[4];
+	AkReal32 lowLanes[4];
+	AkReal32 highLanes[4];
+	for (AkUInt32 i = 0; i < numFrames; ++i)
+	{
+		frame[0] = frame[2] = in[0][i];
+		frame[1] = frame[3] = stereo ? in[1][i] : 0.0f;
+
+		// (low L, low R, high L, high R) of the first crossover
+		AKSIMD_V4F32 split1 = tick(lanes[split1_b], tick(lanes[split1_a], AKSIMD_LOAD_V4F32(frame)));
+
+		if constexpr (NumBands == 2)
+		{
+			AKSIMD_STORE_V4F32(lowLanes, split1);
+			out[0][0][i] = lowLanes[0];
+			out[1][0][i] = lowLanes[2];
+			if (stereo)
+			{
+				out[0][1][i] = lowLanes[1];
+				out[1][1][i] = lowLanes[3];
+			}
+		}
+		else
+		{
+			// the high band of the first crossover goes through the second one
+			AKSIMD_V4F32 split2 = tick(lanes[split2_b], tick(lanes[split2_a], AKSIMD_SHUFFLE_V4F32(split1, split1, AKSIMD_SHUFFLE(3, 2, 3, 2))));
+
+			// (band 0 L, band 0 R, band 1 L, band 1 R) realigned with the crossovers above them
+			AKSIMD_V4F32 aligned = tick(lanes[allpass_a], AKSIMD_SHUFFLE_V4F32(split1, split2, AKSIMD_SHUFFLE(1, 0, 1, 0)));
+
+			if constexpr (NumBands == 3)
+			{
+				AKSIMD_STORE_V4F32(lowLanes, aligned);
+				AKSIMD_STORE_V4F32(highLanes, split2);
+			}
+			else
+			{
+				AKSIMD_V4F32 split3 = tick(lanes[split3_b], tick(lanes[split3_a], AKSIMD_SHUFFLE_V4F32(split2, split2, AKSIMD_SHUFFLE(3, 2, 3, 2))));
+				AKSIMD_V4F32 band0 = tick(lanes[allpass_b], aligned);
+				AKSIMD_STORE_V4F32(lowLanes, AKSIMD_SHUFFLE_V4F32(band0, aligned, AKSIMD_SHUFFLE(3, 2, 1, 0)));
+				AKSIMD_STORE_V4F32(highLanes, split3);
+			}
+
+			out[0][0][i] = lowLanes[0];
+			out[1][0][i] = lowLanes[2];
+			out[NumBands - 2][0][i] = highLanes[0];
+			out[NumBands - 1][0][i] = highLanes[2];
+			if (stereo)
+			{
+				out[0][1][i] = lowLanes[1];
+				out[1][1][i] = lowLanes[3];
+				out[NumBands - 2][1][i] = highLanes[1];
+				out[NumBands - 1][1][i] = highLanes[3];
+			}
+		}
+	}
+
+	for (AkUInt16 section = 0; section < usedSections; ++section)
+	{
+		AKSIMD_STORE_V4F32(state[section][0], lanes[section].z1);
+		AKSIMD_STORE_V4F32(state[section][1], lanes[section].z2);
+	}
+}
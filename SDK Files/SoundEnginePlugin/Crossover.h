@@ -0,0 +1,52 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/AkSimd.h>
+
+// Linkwitz-Riley (LR4) crossover splitting up to two channels into 2 to 4 bands.
+// Every LR4 section is two cascaded Butterworth biquads. The left/right low-pass and left/right high-pass
+// of one section run side by side in the 4 SIMD lanes, so a whole section costs about as much as one mono biquad.
+// Lower bands also go through the allpass of every crossover above them, so the bands always sum back flat.
+class Crossover
+{
+public:
+	static constexpr AkUInt16 kMaxBands = 4;
+
+	void setup(AkUInt16 in_numBands, const AkReal32 frequencies[kMaxBands - 1], AkUInt32 sampleRate);	// keeps filter memory, so it can follow RTPCs
+	void reset();																							// clears filter memory
+	void process(const AkReal32* const in[2], AkUInt16 numChannels, AkUInt32 numFrames, AkReal32* const out[kMaxBands][2]);
+	AkUInt16 getNumBands() const { return numBands; }
+
+private:
+	enum Section
+	{
+		split1_a = 0,		// first crossover, low-pass in lanes 0-1 and high-pass in lanes 2-3
+		split1_b,
+		split2_a,			// second crossover, fed with the high band of the first
+		split2_b,
+		split3_a,
+		split3_b,
+		allpass_a,			// lanes 0-1 realign band 0 with the second crossover, lanes 2-3 realign band 1 with the third
+		allpass_b,			// lanes 0-1 realign band 0 with the third crossover
+		numSections
+	};
+
+	enum Coefficient
+	{
+		coef_b0 = 0,
+		coef_b1,
+		coef_b2,
+		coef_a1,
+		coef_a2,
+		numCoefficients
+	};
+
+	template <AkUInt16 NumBands>
+	void processBands(const AkReal32* const in[2], AkUInt16 numChannels, AkUInt32 numFrames, AkReal32* const out[kMaxBands][2]);
+
+	void setLane(Section section, AkUInt16 lane, const AkReal32 coefficients[numCoefficients]);
+
+	AkUInt16 numBands = 1;
+	AkReal32 coefficients[numSections][numCoefficients][4] = {};	// [section][coefficient][lane], normalized by a0
+	AkReal32 state[numSections][2][4] = {};							// [section][z1/z2][lane], transposed direct form II
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// Table-based dB <-> linear conversions for the per-sample path, generated at compile time.
+// toLinear() covers gains from -144 dB to 0 dB, clamped like the gain stage always did, within 0.001 dB.
+// fromLinear() splits the float into exponent and mantissa and interpolates log2 of the mantissa, within 0.0001 dB.
+namespace Decibels
+{
+	namespace Detail
+	{
+		constexpr AkReal32 kMinGainDB = -144.0f;
+		constexpr AkInt32 kGainStepsPerDB = 4;
+		constexpr AkInt32 kGainTableSize = (-static_cast<AkInt32>(kMinGainDB) * kGainStepsPerDB) + 1;
+		constexpr AkInt32 kMantissaBits = 8;
+		constexpr AkInt32 kMantissaTableSize = (1 << kMantissaBits) + 1;
+
+		// e^x for the small |x| the tables need, Taylor series
+		constexpr double exp(double x)
+		{
+			double sum = 1.0;
+			double term = 1.0;
+			for (int n = 1; n < 30; ++n)
+			{
+				term *= x / n;
+				sum += term;
+			}
+			return sum;
+		}
+
+		// ln(y) for y in [1, 2], through atanh((y - 1) / (y + 1)) which converges quickly there
+		constexpr double log(double y)
+		{
+			const double z = (y - 1.0) / (y + 1.0);
+			double sum = 0.0;
+			double power = z;
+			for (int n = 0; n < 30; ++n)
+			{
+				sum += power / ((2 * n) + 1);
+				power *= z * z;
+			}
+			return 2.0 * sum;
+		}
+
+		constexpr double kLn10 = 2.302585092994045684;
+		constexpr double kLn2 = 0.693147180559945309;
+
+		// gain at every quarter dB from kMinGainDB up to 0 dB, built by repeated multiplication in double
+		constexpr std::array<AkReal32, kGainTableSize> makeGainTable()
+		{
+			std::array<AkReal32, kGainTableSize> table = {};
+			const double step = exp(kLn10 / (20.0 * kGainStepsPerDB));
+			double gain = 1.0;
+			for (AkInt32 i = kGainTableSize - 1; i >= 0; --i)
+			{
+				table[i] = static_cast<AkReal32>(gain);
+				gain /= step;
+			}
+			return table;
+		}
+
+		// log2(1 + i / 256), so a mantissa can be looked up by its top bits
+		constexpr std::array<AkReal32, kMantissaTableSize> makeMantissaTable()
+		{
+			std::array<AkReal32, kMantissaTableSize> table = {};
+			for (AkInt32 i = 0; i < kMantissaTableSize; ++i)
+			{
+				table[i] = static_cast<AkReal32>(log(1.0 + (static_cast<double>(i) / (1 << kMantissaBits))) / kLn2);
+			}
+			return table;
+		}
+
+		constexpr std::array<AkReal32, kGainTableSize> kGainTable = makeGainTable();
+		constexpr std::array<AkReal32, kMantissaTableSize> kMantissaTable = makeMantissaTable();
+	}
+
+	/// Gain in dB to linear, clamped to [-144, 0] dB. NaN gives the -144 dB floor.
+	inline AkReal32 toLinear(AkReal32 gainDB)
+	{
+		using namespace Detail;
+		const AkReal32 floored = (gainDB > kMinGainDB) ? gainDB : kMinGainDB;		// NaN goes to the floor
+		const AkReal32 position = (((floored < 0.0f) ? floored : 0.0f) - kMinGainDB) * kGainStepsPerDB;
+		const AkInt32 index = std::min(static_cast<AkInt32>(position), kGainTableSize - 2);
+		const AkReal32 fraction = position - static_cast<AkReal32>(index);
+		return kGainTable[index] + ((kGainTable[index + 1] - kGainTable[index]) * fraction);
+	}
+
+	/// Linear to dB. 0 and denormals come out around -760 dB instead of -inf, so what follows never sees NaN.
+	inline AkReal32 fromLinear(AkReal32 linear)
+	{
+		using namespace Detail;
+		AkUInt32 bits;
+		memcpy(&bits, &linear, sizeof(bits));
+		const AkInt32 exponent = static_cast<AkInt32>((bits >> 23) & 0xFF) - 127;
+		const AkUInt32 mantissa = bits & 0x7FFFFF;
+		const AkUInt32 index = mantissa >> (23 - kMantissaBits);
+		const AkReal32 fraction = static_cast<AkReal32>(mantissa & ((1 << (23 - kMantissaBits)) - 1)) * (1.0f / (1 << (23 - kMantissaBits)));
+		const AkReal32 octaves = static_cast<AkReal32>(exponent) + kMantissaTable[index] + ((kMantissaTable[index + 1] - kMantissaTable[index]) * fraction);
+		return octaves * static_cast<AkReal32>(20.0 * kLn2 / kLn10);
+	}
+}
@@ -0,0 +1,37 @@
+#include "GainCurve.h"
+
+AkReal32 GainCurve::analyticGainDB(AkReal32 inputDB, AkReal32 thresholdDB, AkReal32 kneeDB, AkReal32 ratio)
+{
+	// Entire formula: https://www.desmos.com/calculator/eu6xlluw9h
+	const AkReal32& x = inputDB;
+	AkReal32 y = x;													// no compression below the knee
+
+	if (x > thresholdDB + (kneeDB / 2))								// above both threshold and knee
+	{
+		y = ((x - thresholdDB) / ratio) + thresholdDB;
+	}
+	else if (x > thresholdDB - (kneeDB / 2))						// inside the knee
+	{
+		AkReal32 m = ((1 / ratio) - 1) / (2 * kneeDB);
+		y = x + (m * powf(x - (thresholdDB - (kneeDB / 2)), 2));
+	}
+
+	return y - x;
+}
+
+void GainCurve::setup(AkReal32 thresholdDB, AkReal32 kneeDB, AkReal32 in_ratio)
+{
+	if (thresholdDB == threshold && kneeDB == knee && in_ratio == ratio)
+	{
+		return;
+	}
+	threshold = thresholdDB;
+	knee = kneeDB;
+	ratio = in_ratio;
+	slopeAbove = (1 / ratio) - 1;
+
+	for (AkInt32 i = 0; i < kTableSize; ++i)
+	{
+		table[i] = analyticGainDB(kMinDB + (static_cast<AkReal32>(i) / kStepsPerDB), threshold, knee, ratio);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <algorithm>
+
+// The threshold/knee/ratio static curve, sampled every quarter dB from -120 dB to +12 dB.
+// It only depends on its three parameters, so it is rebuilt when one of them changes (the ratio follows the
+// priority percentile) and the per-sample path is a clamped, linearly interpolated lookup with no branches.
+// Above +12 dB the curve is a straight line and gets extrapolated, below -120 dB it holds.
+class GainCurve
+{
+public:
+	static constexpr AkReal32 kMinDB = -120.0f;
+	static constexpr AkReal32 kMaxDB = 12.0f;
+	static constexpr AkInt32 kStepsPerDB = 4;
+	static constexpr AkInt32 kTableSize = (static_cast<AkInt32>(kMaxDB - kMinDB) * kStepsPerDB) + 1;
+
+	void setup(AkReal32 thresholdDB, AkReal32 kneeDB, AkReal32 ratio);	// cheap when nothing changed
+	AkReal32 gainDB(AkReal32 inputDB) const;							// negative when compressing, NaN input gives the gain at kMinDB
+
+	static AkReal32 analyticGainDB(AkReal32 inputDB, AkReal32 thresholdDB, AkReal32 kneeDB, AkReal32 ratio);	// the curve the table samples
+
+private:
+	AkReal32 threshold = 0.0f;
+	AkReal32 knee = 0.0f;
+	AkReal32 ratio = 0.0f;				// 0 until the first setup
+	AkReal32 slopeAbove = 0.0f;			// dB of gain per dB of input above kMaxDB
+	AkReal32 table[kTableSize] = {};
+};
+
+inline AkReal32 GainCurve::gainDB(AkReal32 inputDB) const
+{
+	// written so NaN goes to kMinDB and the compiler can use plain min/max instructions, unlike std::fmin/fmax
+	const AkReal32 floored = (inputDB > kMinDB) ? inputDB : kMinDB;
+	const AkReal32 clamped = (floored < kMaxDB) ? floored : kMaxDB;
+	const AkReal32 position = (clamped - kMinDB) * kStepsPerDB;
+	const AkInt32 index = std::min(static_cast<AkInt32>(position), kTableSize - 2);
+	const AkReal32 fraction = position - static_cast<AkReal32>(index);
+	const AkReal32 above = floored - clamped;
+	return table[index] + ((table[index + 1] - table[index]) * fraction) + (above * slopeAbove);
+}
@@ -0,0 +1,23 @@
+#include "GainReductionQuery.h"
+#include "SharedBuffer.h"
+
+namespace AutoCompressorQuery
+{
+	bool GetGroup(AkInt32 group, GroupInfo& out_info)
+	{
+		if (group < 0 || group >= GlobalManager::kNumGroups)
+		{
+			return false;
+		}
+		return GlobalManager::getGlobalSharedBuffer(group)->readSnapshot(out_info);
+	}
+
+	bool GetGameObject(AkInt32 group, AkGameObjectID gameObject, InstanceInfo& out_info)
+	{
+		if (group < 0 || group >= GlobalManager::kNumGroups)
+		{
+			return false;
+		}
+		return GlobalManager::getGlobalSharedBuffer(group)->readGameObject(gameObject, out_info);
+	}
+}
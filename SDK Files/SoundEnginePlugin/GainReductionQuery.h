@@ -0,0 +1,47 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include "Crossover.h"
+
+// How much AutoCompressor is ducking, for game code: HUD meters, haptics, subtitle emphasis.
+// Every group publishes a snapshot once per tick, after its last instance ran. The functions below copy it out
+// from any thread without taking the audio thread's locks, so polling them every frame is fine.
+namespace AutoCompressorQuery
+{
+	constexpr AkUInt16 kMaxReportedInstances = 64;		// per group, instances past this are counted but not listed, GetGameObject still finds them
+
+	struct InstanceInfo
+	{
+		AkGameObjectID gameObject;						// AK_INVALID_GAME_OBJECT for instances on a bus
+		AkUniqueID audioNode;							// the sound the instance is inserted on
+		AkReal32 priority;
+		AkReal32 gainReductionDB;						// positive, the most ducked band
+		AkReal32 bandGainReductionDB[Crossover::kMaxBands];
+		AkUInt8 envState[Crossover::kMaxBands];			// 0 idle, 1 attack, 2 sustain, 3 release
+		AkUInt8 numBands;
+		bool culled;									// sat the last tick out, see the CullBelow and CullKeep parameters
+		bool virtualized;								// sat it out because the engine made its voice virtual, never culled then
+	};
+
+	struct GroupInfo
+	{
+		AkUInt32 tick;									// the group's tick counter, a poll that sees the same value got no news
+		AkReal32 sidechainDB[2];						// level of the whole group, left and right
+		AkUInt16 numInstances;
+		AkUInt16 numCulled;								// on the last tick, virtual voices aside
+		AkUInt16 numVirtual;
+		AkUInt16 numReported;							// entries of instances, in slot order
+		AkUInt8 qualityTier;							// 0 full, 1 sub-block, 2 block rate, stepped down while the group is over its CPU budget
+		AkUInt32 tierDowns;								// quality tier changes since the group was first used
+		AkUInt32 tierUps;
+		InstanceInfo instances[kMaxReportedInstances];
+	};
+
+	// False when group is out of range or a consistent copy couldn't be had, which only happens when polling in a tight loop.
+	bool GetGroup(AkInt32 group, GroupInfo& out_info);
+
+	// The most ducked instance playing on gameObject in group, among all of them rather than the ones GetGroup lists.
+	// False if there is none, or when a consistent copy couldn't be had, like GetGroup.
+	bool GetGameObject(AkInt32 group, AkGameObjectID gameObject, InstanceInfo& out_info);
+}
@@ -0,0 +1,218 @@
+#include "InstancePool.h"
+
+#include <mutex>
+#include <vector>
+
+InstancePool::~InstancePool()
+{
+	for (std::atomic<Chunk*>& entry : chunks)
+	{
+		delete entry.load(std::memory_order_relaxed);
+	}
+}
+
+AkUInt16 InstancePool::allocate(AkUInt16 rowFrames)
+{
+	AkUInt16 slot = claim(rowFrames);
+	if (slot == kNoSlot)
+	{
+		Chunk* addedChunk = newChunk(rowFrames);
+		addedChunk->occupied.store(1, std::memory_order_relaxed);	// its first slot is ours before anyone else can see it
+		const size_t index = install(addedChunk);
+		if (index == kMaxChunks)
+		{
+			delete addedChunk;
+			return kNoSlot;
+		}
+		slot = static_cast<AkUInt16>(index * kSlotsPerChunk);
+	}
+
+	publish(slot, nullptr);
+	return slot;
+}
+
+AkUInt16 InstancePool::tryAllocate(AkUInt16 rowFrames, const State& carried)
+{
+	AkUInt16 slot = claim(rowFrames);
+	for (AkUInt16 spare = 0; spare < kSpareChunks && slot == kNoSlot; ++spare)
+	{
+		std::atomic<Chunk*>& entry = spares()[spare];
+		Chunk* spareChunk = entry.load(std::memory_order_acquire);
+		if (spareChunk == nullptr || spareChunk->rowFrames < rowFrames || !entry.compare_exchange_strong(spareChunk, nullptr, std::memory_order_acquire))
+		{
+			continue;
+		}
+		spareChunk->occupied.store(1, std::memory_order_relaxed);
+		const size_t index = install(spareChunk);
+		if (index == kMaxChunks)
+		{
+			spareChunk->occupied.store(0, std::memory_order_relaxed);
+			entry.store(spareChunk, std::memory_order_release);		// back on the shelf for a pool that has room
+			return kNoSlot;
+		}
+		slot = static_cast<AkUInt16>(index * kSlotsPerChunk);
+	}
+	if (slot == kNoSlot)
+	{
+		return kNoSlot;
+	}
+
+	publish(slot, &carried);
+	return slot;
+}
+
+void InstancePool::reserveSpares(AkUInt16 rowFrames)
+{
+	for (AkUInt16 spare = 0; spare < kSpareChunks; ++spare)
+	{
+		std::atomic<Chunk*>& entry = spares()[spare];
+		Chunk* current = entry.load(std::memory_order_acquire);
+		if (current != nullptr && current->rowFrames >= rowFrames)
+		{
+			continue;
+		}
+
+		// a spare with rows too short is swapped for a longer one, unless a move took it in the meantime. The old one is
+		// kept rather than freed, a move on the audio thread may be looking at it
+		Chunk* replacement = newChunk(rowFrames);
+		if (!entry.compare_exchange_strong(current, replacement, std::memory_order_acq_rel))
+		{
+			delete replacement;
+			continue;
+		}
+		if (current != nullptr)
+		{
+			static std::mutex retiredMutex;
+			static std::vector<std::unique_ptr<Chunk>> retired;
+			std::lock_guard<std::mutex> lock(retiredMutex);
+			retired.emplace_back(current);
+		}
+	}
+}
+
+void InstancePool::release(AkUInt16 slot)
+{
+	if (isActive(slot))
+	{
+		// out of the walks first, then free. Whatever a tick close already took of it stays as it was, see publish()
+		Chunk& thisChunk = chunkOf(slot);
+		thisChunk.live.fetch_and(~(1u << lane(slot)), std::memory_order_release);
+		thisChunk.occupied.fetch_and(~(1u << lane(slot)), std::memory_order_release);
+	}
+}
+
+bool InstancePool::isActive(AkUInt16 slot) const
+{
+	const Chunk* thisChunk = (slot / kSlotsPerChunk < kMaxChunks) ? chunks[slot / kSlotsPerChunk].load(std::memory_order_acquire) : nullptr;
+	return thisChunk != nullptr && (thisChunk->live.load(std::memory_order_acquire) & (1u << lane(slot))) != 0;
+}
+
+void InstancePool::liveLanes(AkUInt32 live, AkReal32 out_active[kSlotsPerChunk])
+{
+	for (AkUInt16 i = 0; i < kSlotsPerChunk; ++i)
+	{
+		out_active[i] = static_cast<AkReal32>((live >> i) & 1u);
+	}
+}
+
+AkUInt16 InstancePool::claim(AkUInt16 rowFrames)
+{
+	for (size_t index = 0; index < numChunks(); ++index)
+	{
+		Chunk* thisChunk = chunk(index);
+		if (thisChunk == nullptr || thisChunk->rowFrames < rowFrames)
+		{
+			continue;
+		}
+
+		// the lowest free bit, claimed with a compare-exchange so two instances registering at once never share it
+		AkUInt32 occupied = thisChunk->occupied.load(std::memory_order_relaxed);
+		while (occupied != (1u << kSlotsPerChunk) - 1)
+		{
+			AkUInt16 free = 0;
+			while (occupied & (1u << free))
+			{
+				free++;
+			}
+			if (thisChunk->occupied.compare_exchange_weak(occupied, occupied | (1u << free), std::memory_order_acquire))
+			{
+				return static_cast<AkUInt16>((index * kSlotsPerChunk) + free);
+			}
+		}
+	}
+	return kNoSlot;
+}
+
+size_t InstancePool::install(Chunk* newChunk)
+{
+	for (size_t index = 0; index < kMaxChunks; ++index)
+	{
+		Chunk* expected = nullptr;
+		if (chunks[index].compare_exchange_strong(expected, newChunk, std::memory_order_release))
+		{
+			size_t count = chunkCount.load(std::memory_order_relaxed);
+			while (count < index + 1 && !chunkCount.compare_exchange_weak(count, index + 1, std::memory_order_release))
+			{
+			}
+			return index;
+		}
+	}
+	return kMaxChunks;
+}
+
+InstancePool::Chunk* InstancePool::newChunk(AkUInt16 rowFrames)
+{
+	Chunk* addedChunk = new Chunk();
+	addedChunk->rows.reset(new AkReal32[static_cast<size_t>(kSlotsPerChunk) * 2 * rowFrames]());
+	addedChunk->rowFrames = rowFrames;
+	return addedChunk;
+}
+
+std::atomic<InstancePool::Chunk*>* InstancePool::spares()
+{
+	// freed with the process, like the busses the pools live in
+	struct Spares
+	{
+		std::atomic<Chunk*> chunks[kSpareChunks] = {};
+		~Spares()
+		{
+			for (std::atomic<Chunk*>& entry : chunks)
+			{
+				delete entry.load(std::memory_order_relaxed);
+			}
+		}
+	};
+	static Spares stock;
+	return stock.chunks;
+}
+
+void InstancePool::publish(AkUInt16 slot, const State* carried)
+{
+	// The walks leave a slot that isn't live alone but for its bus-side rows, which they keep at 0, the same as clear() writes
+	clear(slot);
+	if (carried != nullptr)
+	{
+		State& thisState = state(slot);
+		thisState = *carried;
+		thisState.contributed = 0;		// whatever it left in its old row stays on the old bus
+	}
+	chunkOf(slot).live.fetch_or(1u << lane(slot), std::memory_order_release);
+}
+
+void InstancePool::clear(AkUInt16 slot)
+{
+	Chunk& thisChunk = chunkOf(slot);
+	const AkUInt16 i = lane(slot);
+	for (AkUInt16 channel = 0; channel < 2; ++channel)
+	{
+		for (AkUInt16 key = 0; key < kNumKeys; ++key)
+		{
+			thisChunk.contribution[key][channel][i] = 0.0f;
+			thisChunk.others_ms[key][channel][i] = 0.0f;
+			thisChunk.lastbuffer_looRMS[key][channel][i] = 0.0f;
+			thisChunk.newbuffer_looRMS[key][channel][i] = 0.0f;
+		}
+		thisChunk.decay[channel][i] = 1.0f;
+	}
+	thisChunk.state[i] = State();
+}
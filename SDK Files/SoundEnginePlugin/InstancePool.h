@@ -0,0 +1,111 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <atomic>
+#include <memory>
+#include "Crossover.h"
+#include "GainReductionQuery.h"
+#include "Seqlock.h"
+
+constexpr size_t kCacheLineSize = 64;
+
+// Per-bus storage for everything the instances of a group keep per tick, handed out by slot.
+// Slots come in chunks that never move once allocated, so an instance can hold on to its State while the pool grows.
+// Within a chunk, every bus-side field is an array over the chunk's slots, a cache line of floats per key and channel,
+// so closing a tick streams through them instead of hopping from instance to instance.
+// Slots are claimed and freed, and chunks added, with atomics only: the tick close walks the pool while instances on other
+// threads come and go, and none of them takes a lock for it. A slot only counts as live once whoever claimed it has cleared it,
+// and stops counting before it is freed, which leaves the slot as it was: the tick close may still be reading it, and the
+// next claimant clears it instead.
+class InstancePool
+{
+public:
+	static constexpr AkUInt16 kMaxBands = Crossover::kMaxBands;
+	static constexpr AkUInt16 kNumKeys = 1 + kMaxBands;		// sidechain keys: the full band, then one per crossover band
+	static constexpr AkUInt16 kSlotsPerChunk = kCacheLineSize / sizeof(AkReal32);
+	static constexpr AkUInt16 kEnvelopePoints = 8;				// sidechain points per tick, see SharedBuffer::envelopeMS
+	static constexpr AkUInt16 kMaxChunks = 256;				// 4096 instances per bus
+	static constexpr AkUInt16 kNoSlot = 0xFFFF;
+	static constexpr AkUInt16 kSpareChunks = 2;				// kept aside for tryAllocate(), shared by every pool
+
+	// The hot DSP state of one instance, only written by that instance (the tick close reads what it left for the bus, and
+	// clears contributed). Plain data so it can be cleared and moved between busses by assignment, and a whole number of cache
+	// lines so neighbours never share one.
+	struct alignas(kCacheLineSize) State
+	{
+		AkReal32 env_target[kMaxBands][2];			// target gain (w/o envelope), but positive
+		AkReal32 env_ratio[kMaxBands][2];			// ratio of dry signal affected by envelope, between 0 & 1
+		AkReal32 env_output[kMaxBands][2];			// output based on env_ratio, in dB
+		AkReal32 env_outputPeak[kMaxBands][2];
+		AkReal32 mixOutput[kMaxBands][2];
+		AkReal32 myMS[kNumKeys][2];					// moving mean square of the instance's dry signal, per sidechain key, in linear power
+		AkReal32 lastKeyRMS[kNumKeys][2];			// leave-one-out RMS of the bus, i.e. every instance but this one
+		AkReal32 newKeyRMS[kNumKeys][2];
+		AkReal32 envelopeMS[kEnvelopePoints][kNumKeys][2];	// this instance's share of each point of SharedBuffer::envelopeMS, on its last tick
+		AkUInt16 envelopeFrames;					// frames of that tick, 0 before the first one
+		AkReal32 blockMS;							// mean square of this tick's buffer, what culling goes by
+		AkReal32 priority;
+		AkGameObjectID gameObject;					// who the instance is, for SharedBuffer::publishSnapshot
+		AkUniqueID audioNode;
+		AkUInt32 signalRate;						// the dry signal this tick left in the slot's row, for the tick close to sum
+		AkUInt16 signalFrames;
+		AkUInt8 signalChannels;
+		AkUInt8 env_state[kMaxBands];
+		AkUInt8 numBands;
+		AkUInt8 culled;								// sat this tick out
+		AkUInt8 virtualized;						// sat it out in TimeSkip, a virtual voice rather than a culled one
+		AkUInt8 contributed;						// left its dry signal in the row this tick, the tick close clears it once it summed it
+	};
+
+	// What the last tick close reported of a chunk's instances, for AutoCompressorQuery to look an instance up from any thread
+	struct Report
+	{
+		AkUInt32 live;												// the lanes reported, the others are stale
+		AutoCompressorQuery::InstanceInfo instances[kSlotsPerChunk];
+	};
+
+	struct alignas(kCacheLineSize) Chunk
+	{
+		AkReal32 contribution[kNumKeys][2][kSlotsPerChunk];			// this tick's share of the moving mean square, in linear power
+		AkReal32 decay[2][kSlotsPerChunk];							// how much of the previous moving mean square survives one tick
+		AkReal32 others_ms[kNumKeys][2][kSlotsPerChunk];			// moving mean square of every other instance on the bus
+		AkReal32 lastbuffer_looRMS[kNumKeys][2][kSlotsPerChunk];	// leave-one-out RMS of the previous buffer
+		AkReal32 newbuffer_looRMS[kNumKeys][2][kSlotsPerChunk];
+		State state[kSlotsPerChunk];
+		std::unique_ptr<AkReal32[]> rows;							// every slot's dry signal of this tick, left then right, rowFrames each
+		AkUInt16 rowFrames = 0;
+		std::atomic<AkUInt32> occupied = 0;							// a bit per slot, claimed or not
+		std::atomic<AkUInt32> live = 0;								// a bit per slot whose instance is in, what the walks go by
+		Seqlock<Report> report;										// only the tick close publishes it
+
+		AkReal32* row(AkUInt16 lane, AkUInt16 channel) { return rows.get() + (((static_cast<size_t>(lane) * 2) + channel) * rowFrames); }
+	};
+
+	~InstancePool();
+
+	AkUInt16 allocate(AkUInt16 rowFrames);					// the lowest free slot with rows this long, cleared, growing the pool by a chunk when full. kNoSlot past kMaxChunks
+	AkUInt16 tryAllocate(AkUInt16 rowFrames, const State& carried);	// allocate() from the audio thread, for an instance bringing its State along: never allocates, takes a spare chunk when full. kNoSlot when there is none that fits
+	static void reserveSpares(AkUInt16 rowFrames);			// tops the spare chunks up to kSpareChunks with rows at least this long, from Init
+	void release(AkUInt16 slot);
+	bool isActive(AkUInt16 slot) const;
+	static void liveLanes(AkUInt32 live, AkReal32 out_active[kSlotsPerChunk]);	// a chunk's live mask as 1 or 0 per lane, so the walks can multiply instead of branching
+
+	size_t numChunks() const { return chunkCount.load(std::memory_order_acquire); }
+	Chunk* chunk(size_t index) { return chunks[index].load(std::memory_order_acquire); }	// null while a chunk is being added there
+	const Chunk* chunk(size_t index) const { return chunks[index].load(std::memory_order_acquire); }
+	Chunk& chunkOf(AkUInt16 slot) { return *chunks[slot / kSlotsPerChunk].load(std::memory_order_acquire); }
+	static AkUInt16 lane(AkUInt16 slot) { return slot % kSlotsPerChunk; }	// the slot's index in the arrays of its chunk
+	State& state(AkUInt16 slot) { return chunkOf(slot).state[lane(slot)]; }
+
+private:
+	AkUInt16 claim(AkUInt16 rowFrames);						// kNoSlot when every chunk with rows this long is full
+	size_t install(Chunk* newChunk);						// the index it went to, kMaxChunks when the pool is full
+	void clear(AkUInt16 slot);
+	void publish(AkUInt16 slot, const State* carried);		// clears the slot, or fills it with carried, and makes it live, after a claim
+	static Chunk* newChunk(AkUInt16 rowFrames);
+	static std::atomic<Chunk*>* spares();					// kSpareChunks of them, null where one was taken
+
+	std::atomic<Chunk*> chunks[kMaxChunks] = {};
+	std::atomic<size_t> chunkCount = 0;						// one past the last chunk added, the walks stop there
+};
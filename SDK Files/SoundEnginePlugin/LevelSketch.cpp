@@ -0,0 +1,80 @@
+#include "LevelSketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr AkReal64 kRescaleAbove = 1e12;		// far from the double range, close enough that old bins keep some precision
+}
+
+void LevelSketch::setHorizon(AkReal32 ticks)
+{
+	growth = exp(1.0 / std::max(static_cast<AkReal64>(ticks), 1.0));
+}
+
+void LevelSketch::add(AkReal32 levelDB)
+{
+	// time moves on whether or not the tick gets through the gate
+	const AkReal64 thisWeight = weight;
+	weight *= growth;
+	if (levelDB >= kMinDB)		// false for NaN and -inf too
+	{
+		const AkInt32 bin = std::min(static_cast<AkInt32>((levelDB - kMinDB) * kBinsPerDB), kNumBins - 1);
+		bins[bin] += thisWeight;
+		total += thisWeight;
+		below += (bin < cursor) ? thisWeight : 0.0;
+	}
+
+	if (weight > kRescaleAbove)
+	{
+		rescale();
+	}
+}
+
+AkReal32 LevelSketch::quantileDB(AkReal32 fraction)
+{
+	if (total <= 0.0)
+	{
+		return NAN;
+	}
+
+	const AkReal64 target = std::clamp(static_cast<AkReal64>(fraction), 0.0, 1.0) * total;
+	while (cursor < kNumBins - 1 && below + bins[cursor] < target)
+	{
+		below += bins[cursor];
+		cursor++;
+	}
+	while (cursor > 0 && below > target)
+	{
+		cursor--;
+		below -= bins[cursor];
+	}
+
+	// somewhere inside the cursor's bin, in proportion to how much of its weight the target needs
+	const AkReal64 inside = (bins[cursor] > 0.0) ? std::clamp((target - below) / bins[cursor], 0.0, 1.0) : 0.0;
+	return kMinDB + static_cast<AkReal32>((cursor + inside) / kBinsPerDB);
+}
+
+void LevelSketch::reset()
+{
+	std::fill(bins, bins + kNumBins, 0.0);
+	weight = 1.0;
+	total = 0.0;
+	below = 0.0;
+	cursor = 0;
+}
+
+void LevelSketch::rescale()
+{
+	const AkReal64 scale = 1.0 / weight;
+	total = 0.0;
+	below = 0.0;
+	for (AkInt32 bin = 0; bin < kNumBins; ++bin)
+	{
+		bins[bin] *= scale;
+		total += bins[bin];
+		below += (bin < cursor) ? bins[bin] : 0.0;		// also clears whatever rounding the cursor walks piled up
+	}
+	weight = 1.0;
+}
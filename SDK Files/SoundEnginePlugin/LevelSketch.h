@@ -0,0 +1,32 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+// Streaming quantile of a level in dB over a fading time horizon, in fixed memory.
+// Levels are counted in half-dB bins from kMinDB to kMaxDB. Anything under kMinDB is gated out like the silence between sounds,
+// anything over kMaxDB lands in the top bin. Instead of decaying every bin each tick, every new tick weighs a little more than the
+// one before, so add() is O(1). The bins are rescaled once the weights grow large, every few minutes.
+// The quantile is a cursor that walks from where it was on the previous call, which is a bin or two as the levels drift.
+class LevelSketch
+{
+public:
+	static constexpr AkReal32 kMinDB = -70.0f;
+	static constexpr AkReal32 kMaxDB = 12.0f;
+	static constexpr AkInt32 kBinsPerDB = 2;
+	static constexpr AkInt32 kNumBins = static_cast<AkInt32>(kMaxDB - kMinDB) * kBinsPerDB;
+
+	void setHorizon(AkReal32 ticks);				// ticks it takes for a level to fade to 1/e of its weight
+	void add(AkReal32 levelDB);						// one tick, gated below kMinDB
+	AkReal32 quantileDB(AkReal32 fraction);			// fraction between 0 and 1, NaN until a level got through the gate
+	void reset();
+
+private:
+	void rescale();
+
+	AkReal64 bins[kNumBins] = {};					// in doubles, the weights span many orders of magnitude between rescales
+	AkReal64 growth = 1.0;							// how much more a tick weighs than the one before
+	AkReal64 weight = 1.0;							// weight of the next tick
+	AkReal64 total = 0.0;
+	AkReal64 below = 0.0;							// weight in the bins under the cursor
+	AkInt32 cursor = 0;
+};
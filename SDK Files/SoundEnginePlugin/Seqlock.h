@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// One writer publishes a plain struct, any number of readers copy it out without ever blocking the writer.
+// The sequence is odd while a publish is under way. A reader copies the value, then checks the sequence didn't move,
+// so it either gets a whole snapshot or tries again. The writer never waits on anybody, which is what the audio thread needs.
+template <typename T>
+class Seqlock
+{
+	static_assert(std::is_trivially_copyable<T>::value, "a seqlock copies its value byte by byte");
+
+public:
+	static constexpr int kMaxAttempts = 8;					// readers give up rather than spin behind a writer that keeps publishing
+
+	void publish(const T& value)							// the single writer
+	{
+		const unsigned sequence = sequenceNumber.load(std::memory_order_relaxed);
+		sequenceNumber.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(&stored, &value, sizeof(T));
+		sequenceNumber.store(sequence + 2, std::memory_order_release);
+	}
+
+	bool read(T& value) const								// any thread, false when every attempt overlapped a publish
+	{
+		for (int attempt = 0; attempt < kMaxAttempts; ++attempt)
+		{
+			const unsigned before = sequenceNumber.load(std::memory_order_acquire);
+			if (before & 1)
+			{
+				continue;
+			}
+			memcpy(&value, &stored, sizeof(T));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequenceNumber.load(std::memory_order_relaxed) == before)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	std::atomic<unsigned> sequenceNumber = 0;
+	T stored = {};
+};
@@ -1,54 +1,135 @@
 #include "SharedBuffer.h"
+#include "AnalysisWorker.h"
 
-void SharedBuffer::resetSharedBufferAndPriorityList()
+void SharedBuffer::resetSharedBuffer()
 {
-	std::lock_guard<std::mutex> lock(mtx);
+	TIMELINE_SCOPE("resetSharedBuffer");
+	// the grid keeps its storage, only what this tick used goes back to silence
+	for (AkUInt16 channel = 0; channel < 2; ++channel)
 	{
-		sharedBuffer.clear();
-		priorityList.clear();
+		std::fill(tickGrid->channel(channel), tickGrid->channel(channel) + gridFrames, 0.0f);
 	}
+	gridFrames = 0;
+	gridChannels = 0;
 }
 
-void SharedBuffer::resizeSharedBuffer(AkAudioBuffer* sourceBuffer)
+void SharedBuffer::addToSharedBuffer(AkUInt16 slot, AkAudioBuffer* sourceBuffer, AkUInt32 sampleRate)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	if (sourceBuffer->NumChannels() != sharedBuffer.size() || sourceBuffer->uValidFrames != sharedBuffer[0].size())
+	TIMELINE_SCOPE("addToSharedBuffer");
+	InstancePool::Chunk& thisChunk = pool.chunkOf(slot);
+	const AkUInt16 lane = InstancePool::lane(slot);
+	const AkUInt16 numChannels = static_cast<AkUInt16>(AkMin(sourceBuffer->NumChannels(), 2));
+	const AkUInt16 numFrames = AkMin(sourceBuffer->uValidFrames, thisChunk.rowFrames);	// only a buffer longer than the sound engine said they get is cut
+	for (AkUInt16 channel = 0; channel < numChannels; ++channel)
 	{
-		sharedBuffer.resize(sourceBuffer->NumChannels(), std::vector<AkReal32>(sourceBuffer->uValidFrames));
+		const AkReal32* sourceChannel = sourceBuffer->GetChannel(channel);
+		std::copy(sourceChannel, sourceChannel + numFrames, thisChunk.row(lane, channel));
 	}
+
+	InstancePool::State& state = thisChunk.state[lane];
+	state.signalRate = sampleRate;
+	state.signalFrames = numFrames;
+	state.signalChannels = static_cast<AkUInt8>(numChannels);
+	state.contributed = 1;
 }
 
-void SharedBuffer::addToSharedBuffer(AkAudioBuffer* sourceBuffer)
+void SharedBuffer::sumContributions()
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	AkUInt16 numChannels = static_cast<AkUInt16>(sharedBuffer.size());
-	AkUInt32 numFrames = static_cast<AkUInt32>(sharedBuffer[0].size());
-
+	TIMELINE_SCOPE("sumContributions");
+	Grid& thisGrid = *grid.load(std::memory_order_acquire);
+	tickGrid = &thisGrid;
+	tickRate = gridRate.load(std::memory_order_relaxed);
+	tickContributions = 0;
+	std::fill(&envelopeTotal[0][0], &envelopeTotal[0][0] + (kEnvelopePoints * 2), 0.0f);
 
-	for (AkUInt32 channel = 0; channel < numChannels; channel++)
+	for (size_t index = 0; index < pool.numChunks(); ++index)
 	{
-		AkUInt32 frame = 0;
-		numFrames = static_cast<AkUInt32>(AkMin(sharedBuffer[channel].size(), sourceBuffer->uValidFrames));
-		auto& thisChannel = sharedBuffer[channel];
-		AkReal32* AK_RESTRICT sourceChannel = (AkReal32 * AK_RESTRICT)sourceBuffer->GetChannel(channel);
-		while (frame < numFrames)
+		InstancePool::Chunk* chunk = pool.chunk(index);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+		const AkUInt32 live = chunk->live.load(std::memory_order_acquire);
+		for (AkUInt16 lane = 0; lane < InstancePool::kSlotsPerChunk; ++lane)
 		{
-			AkReal32& thisSample = thisChannel[frame];
+			InstancePool::State& state = chunk->state[lane];
+			if ((live & (1u << lane)) == 0 || state.contributed == 0)
+			{
+				continue;										// free, or sat this tick out
+			}
+			state.contributed = 0;
+
+			tickMinPriority = (tickContributions == 0) ? state.priority : AkMin(tickMinPriority, state.priority);
+			tickMaxPriority = (tickContributions == 0) ? state.priority : AkMax(tickMaxPriority, state.priority);
+			tickContributions++;
+
+			// the full band envelope is the sum of every contribution: the mean square of a mix is the sum of its sources' when they
+			// are uncorrelated. Correlated sources (the same sound on two instances, in phase) make it read low
+			for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+			{
+				for (AkUInt16 channel = 0; channel < 2; ++channel)
+				{
+					envelopeTotal[point][channel] += state.envelopeMS[point][kFullBandKey][channel];
+				}
+			}
+
+			const AkUInt16 numChannels = state.signalChannels;
+			const AkUInt32 sourceFrames = state.signalFrames;
+			const AkUInt32 sampleRate = state.signalRate;
+			if (numChannels == 0 || sourceFrames == 0 || sampleRate == 0)
+			{
+				continue;
+			}
+
+			// every contribution starts at the start of the tick and covers as much of the grid as it lasts,
+			// so a short last buffer leaves silence behind it instead of cutting the others short
+			const AkUInt32 numFrames = AkMin(thisGrid.frames, (sampleRate == tickRate)
+				? sourceFrames
+				: static_cast<AkUInt32>(((static_cast<AkUInt64>(sourceFrames) * tickRate) + (sampleRate / 2)) / sampleRate));
+			gridFrames = AkMax(gridFrames, numFrames);
+			gridChannels = AkMax(gridChannels, numChannels);
 
-			thisSample += sourceBuffer->GetChannel(channel)[frame];
+			for (AkUInt16 channel = 0; channel < numChannels; ++channel)
+			{
+				AkReal32* AK_RESTRICT thisChannel = thisGrid.channel(channel);
+				const AkReal32* AK_RESTRICT sourceChannel = chunk->row(lane, channel);
+				if (sampleRate == tickRate)
+				{
+					for (AkUInt32 frame = 0; frame < numFrames; ++frame)
+					{
+						thisChannel[frame] += sourceChannel[frame];
+					}
+					continue;
+				}
 
-			frame++;
+				// other rates are linearly interpolated onto the grid, plenty for a level detector
+				const AkReal64 step = static_cast<AkReal64>(sampleRate) / tickRate;
+				for (AkUInt32 frame = 0; frame < numFrames; ++frame)
+				{
+					const AkReal64 position = frame * step;
+					const AkUInt32 index = AkMin(static_cast<AkUInt32>(position), sourceFrames - 1);
+					const AkUInt32 next = AkMin(index + 1, sourceFrames - 1);
+					const AkReal32 fraction = static_cast<AkReal32>(position - index);
+					thisChannel[frame] += sourceChannel[index] + (fraction * (sourceChannel[next] - sourceChannel[index]));
+				}
+			}
 		}
 	}
 
+	bandsMeasured = bandsRequested.exchange(false, std::memory_order_relaxed);
+	if (bandsMeasured)
+	{
+		applyBandLayout();
+	}
 }
 
-void SharedBuffer::calculatemRMS(AkUInt32 frames10ms)
+void SharedBuffer::calculatemRMS()
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	std::vector<AkReal32> currentRMS = { newbuffer_mRMS[0], newbuffer_mRMS[1] };
-	AkUInt16 numChannels = static_cast<AkUInt16>(sharedBuffer.size());
-	AkUInt32 numFrames = static_cast<AkUInt32>(sharedBuffer[0].size());
+	TIMELINE_SCOPE("calculatemRMS");
+	AkReal32 currentRMS[2] = { newbuffer_mRMS[0], newbuffer_mRMS[1] };
+	AkUInt16 numChannels = gridChannels;
+	AkUInt32 numFrames = gridFrames;										// 0 on a tick where every instance was culled
+	const AkUInt32 frames10ms = tickRate / 100;
 
 	// update lastbuffer_mRMS
 	lastbuffer_mRMS[0] = newbuffer_mRMS[0];
@@ -56,18 +137,17 @@ void SharedBuffer::calculatemRMS(AkUInt32 frames10ms)
 
 
 	// calculated new mRMS
-	if (!sharedBuffer.empty())
+	if (numFrames > 0)
 	{
 		for (AkUInt16 channel = 0; channel < numChannels; ++channel)
 		{
-			AkUInt16 frame = 0;
-			std::vector<AkReal32>& currentChannel = sharedBuffer[channel];
-			numFrames = static_cast<AkUInt32>(currentChannel.size());
+			AkUInt32 frame = 0;
+			const AkReal32* currentChannel = tickGrid->channel(channel);
 
 			while (frame < numFrames)
 			{
 
-				AkReal32& currentSample = currentChannel[frame];
+				const AkReal32& currentSample = currentChannel[frame];
 				currentRMS[channel] = sqrtf(
 					(
 						(powf(currentRMS[channel], 2) * ((frames10ms * numChannels) - 1)    // a fake sum of previous frames' squares
@@ -85,78 +165,642 @@ void SharedBuffer::calculatemRMS(AkUInt32 frames10ms)
 	newbuffer_mRMS[1] = currentRMS[1];
 }
 
-void SharedBuffer::addToPriorityList(AkReal32 priority)
+float SharedBuffer::getRatioPercentile(AkReal32 ratio) const
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	priorityList.push_back(priority);
+	float value = 1.0f;
+	if (minPriority == maxPriority)
+	{
+		const AkUInt16 instances = numInstances.load(std::memory_order_relaxed);
+		if (instances != 0)
+		{
+			value = 1 - static_cast<float>(1 / instances);
+		}
+	}
+	else
+	{
+		value = 1 - static_cast<float>((ratio - minPriority) / (maxPriority - minPriority));
+	}
+	
+	return std::clamp(value, 0.0f, 1.0f);
 }
 
-void SharedBuffer::calculatePriorityMinMax()
+
+AkUInt16 SharedBuffer::registerInstance(AkUInt32 sampleRate, AkUInt16 maxFrames)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	using pairtype = std::pair<AkUniqueID, AkReal32>;
+	BusLock lock(mtx);
+	if (numInstances.load(std::memory_order_relaxed) == 0)
+	{
+		gridRate.store(sampleRate, std::memory_order_relaxed);		// an empty bus takes the rate of whoever comes first, and keeps it while anyone is left
+	}
+	AkUInt16 slot = pool.allocate(maxFrames);
+	if (slot == InstancePool::kNoSlot)
+	{
+		return slot;
+	}
+	numInstances.fetch_add(1, std::memory_order_relaxed);
+
+	// everything a tick close fills up front, so nothing allocates from Execute
+	const AkUInt32 rate = gridRate.load(std::memory_order_relaxed);
+	reserveGrid(static_cast<AkUInt32>(((static_cast<AkUInt64>(maxFrames) * rate) + sampleRate - 1) / sampleRate),
+		static_cast<AkUInt32>(pool.numChunks() * InstancePool::kSlotsPerChunk));
+	return slot;
+}
 
-	if (!priorityList.empty())
+AkUInt16 SharedBuffer::tryRegisterInstance(AkUInt16 maxFrames, const InstancePool::State& carried)
+{
+	// the bus keeps its rate even when it is empty, only Init sets it. The mover is resampled onto it like any other rate
+	AkUInt16 slot = pool.tryAllocate(maxFrames, carried);
+	if (slot != InstancePool::kNoSlot)
 	{
-		// Find Minimum
-		auto iterator = std::min_element(priorityList.begin(), priorityList.end());
-		minPriority = *iterator;
+		numInstances.fetch_add(1, std::memory_order_relaxed);
+	}
+	return slot;
+}
 
-		// Find Maximum
-		iterator = std::max_element(priorityList.begin(), priorityList.end());
-		maxPriority = *iterator;
+void SharedBuffer::reserveForMove(AkUInt32 sampleRate, AkUInt16 maxFrames)
+{
+	BusLock lock(mtx);
+	// a mover is resampled onto this bus's grid. A bus that empties and takes another rate later is sized by whoever
+	// registers then, movers past that get cut
+	const AkUInt32 resampledFrames = static_cast<AkUInt32>(((static_cast<AkUInt64>(maxFrames) * gridRate.load(std::memory_order_relaxed)) + sampleRate - 1) / sampleRate);
+	reserveGrid(resampledFrames, static_cast<AkUInt32>((pool.numChunks() + InstancePool::kSpareChunks) * InstancePool::kSlotsPerChunk));
+}
+
+void SharedBuffer::reserveGrid(AkUInt32 frames, AkUInt32 slots)
+{
+	const Grid* current = grid.load(std::memory_order_relaxed);
+	if (current != nullptr && frames <= current->frames && slots <= current->slots)
+	{
+		return;
 	}
-	else {
-		minPriority = 1.0f;
-		maxPriority = 1.0f;
+	std::unique_ptr<Grid> newGrid(new Grid());
+	newGrid->frames = (current != nullptr) ? AkMax(frames, current->frames) : frames;
+	newGrid->slots = (current != nullptr) ? AkMax(slots, current->slots) : slots;
+	newGrid->samples.reset(new AkReal32[2 * static_cast<size_t>(newGrid->frames)]());
+	newGrid->blockMS.reset(new AkReal32[newGrid->slots]);
+	grid.store(newGrid.get(), std::memory_order_release);
+	grids.push_back(std::move(newGrid));
+}
+
+void SharedBuffer::unregisterInstance(AkUInt16 slot)
+{
+	if (pool.isActive(slot))
+	{
+		pool.release(slot);
+		numInstances.fetch_sub(1, std::memory_order_relaxed);
 	}
 }
 
-float SharedBuffer::getRatioPercentile(AkReal32 ratio) const
+InstancePool::State* SharedBuffer::getInstanceState(AkUInt16 slot)
 {
-	float value = 1.0f;
-	if (minPriority == maxPriority)
+	return &pool.state(slot);
+}
+
+void SharedBuffer::addContribution(AkUInt16 slot, const AkReal32 envelope[kEnvelopePoints][kNumKeys][2], const AkReal32 decay[2])
+{
+	TIMELINE_SCOPE("addContribution");
+	InstancePool::Chunk& thisChunk = pool.chunkOf(slot);
+	const AkUInt16 lane = InstancePool::lane(slot);
+	for (AkUInt16 channel = 0; channel < 2; ++channel)
 	{
-		if (objectList.size() != 0)
+		for (AkUInt16 key = 0; key < kNumKeys; ++key)
 		{
-			value = 1 - static_cast<float>(1 / objectList.size());
+			thisChunk.contribution[key][channel][lane] = envelope[kEnvelopePoints - 1][key][channel];	// the last point is the whole tick
 		}
+		thisChunk.decay[channel][lane] = decay[channel];
 	}
-	else
+	// the points in between only matter summed over the bus, sumContributions() takes them from the instance's State
+}
+
+void SharedBuffer::setBandLayout(AkUInt16 bands, const AkReal32 frequencies[Crossover::kMaxBands - 1])
+{
+	requestedBands.store(bands, std::memory_order_relaxed);
+	for (AkUInt16 split = 0; split < Crossover::kMaxBands - 1; ++split)
 	{
-		value = 1 - static_cast<float>((ratio - minPriority) / (maxPriority - minPriority));
+		requestedFrequencies[split].store(frequencies[split], std::memory_order_relaxed);
+	}
+	bandsRequested.store(true, std::memory_order_relaxed);
+}
+
+void SharedBuffer::applyBandLayout()
+{
+	const AkUInt16 bands = requestedBands.load(std::memory_order_relaxed);
+	AkReal32 frequencies[Crossover::kMaxBands - 1];
+	for (AkUInt16 split = 0; split < Crossover::kMaxBands - 1; ++split)
+	{
+		frequencies[split] = requestedFrequencies[split].load(std::memory_order_relaxed);
+	}
+	if (bands == numBands && tickRate == crossoverSampleRate
+		&& std::equal(frequencies, frequencies + (Crossover::kMaxBands - 1), crossoverFrequencies))
+	{
+		return;
+	}
+
+	// Instances in a group are expected to share their band layout, whoever changes it last wins
+	if (bands != numBands)
+	{
+		crossover.reset();
+		std::fill(&band_mMS[0][0], &band_mMS[0][0] + (Crossover::kMaxBands * 2), 0.0f);
+		for (AkUInt16 key = kFullBandKey + 1; key < kNumKeys; ++key)
+		{
+			autoThresholdDB[key] = NAN;
+		}
+		bandEpoch++;										// the analysis resets the band sketches when it sees it
+	}
+	numBands = bands;
+	crossoverSampleRate = tickRate;
+	std::copy(frequencies, frequencies + (Crossover::kMaxBands - 1), crossoverFrequencies);
+	crossover.setup(numBands, crossoverFrequencies, crossoverSampleRate);
+}
+
+void SharedBuffer::calculateBandEnergies(AkReal32 envelope[kEnvelopePoints][kNumKeys][2])
+{
+	AkUInt16 numChannels = gridChannels;
+	AkUInt32 numFrames = gridFrames;
+	AkReal32 msWeight = 1.0f / ((tickRate / 100) * numChannels);
+
+	// same moving mean square and envelope points the instances use, so the totals can be compared with their contributions
+	AkUInt32 pointFrame[kEnvelopePoints];
+	AkReal32 decay[kEnvelopePoints];
+	for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+	{
+		pointFrame[point] = envelopeFrame(point + 1, static_cast<AkUInt16>(numFrames));
+		decay[point] = powf(1.0f - msWeight, static_cast<AkReal32>(pointFrame[point]));
+	}
+	AkReal32 startMS[Crossover::kMaxBands][2];
+	std::copy(&band_mMS[0][0], &band_mMS[0][0] + (Crossover::kMaxBands * 2), &startMS[0][0]);
+
+	// the grid goes through the crossover a chunk at a time, so the band signals fit in a fixed scratch whatever the buffer length
+	AkReal32* out[Crossover::kMaxBands][2];
+	for (AkUInt16 band = 0; band < Crossover::kMaxBands; ++band)
+	{
+		out[band][0] = bandScratch[band][0];
+		out[band][1] = bandScratch[band][1];
+	}
+	AkUInt16 firstPoint = 0;								// the points before this chunk, each taken right before its frame
+	for (AkUInt32 chunkStart = 0; chunkStart < numFrames; chunkStart += kBandChunkFrames)
+	{
+		const AkUInt32 chunkFrames = AkMin(numFrames - chunkStart, static_cast<AkUInt32>(kBandChunkFrames));
+		const bool lastChunk = chunkStart + chunkFrames == numFrames;
+		const AkReal32* in[2] = { tickGrid->channel(0) + chunkStart, tickGrid->channel(numChannels - 1) + chunkStart };
+		crossover.process(in, numChannels, chunkFrames, out);
+
+		AkUInt16 nextPoint = firstPoint;
+		for (AkUInt16 band = 0; band < numBands; ++band)
+		{
+			const AkUInt16 key = kFullBandKey + 1 + band;
+			for (AkUInt16 channel = 0; channel < numChannels; ++channel)
+			{
+				AkReal32& currentMS = band_mMS[band][channel];
+				const AkReal32* samples = bandScratch[band][channel];
+				AkUInt16 point = firstPoint;
+				for (AkUInt32 frame = 0; frame < chunkFrames; ++frame)
+				{
+					for (; point < kEnvelopePoints && pointFrame[point] <= chunkStart + frame; ++point)
+					{
+						envelope[point][key][channel] = currentMS - (startMS[band][channel] * decay[point]);
+					}
+					currentMS += (samples[frame] * samples[frame] - currentMS) * msWeight;
+				}
+				for (; lastChunk && point < kEnvelopePoints; ++point)
+				{
+					envelope[point][key][channel] = currentMS - (startMS[band][channel] * decay[point]);
+				}
+				nextPoint = point;
+			}
+		}
+		firstPoint = nextPoint;
+	}
+}
+
+void SharedBuffer::calculateLeaveOneOut()
+{
+	TIMELINE_SCOPE("calculateLeaveOneOut");
+	AkReal32 envelope[kEnvelopePoints][kNumKeys][2] = {};
+
+	// the full band envelope is what sumContributions() added up...
+	for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+	{
+		for (AkUInt16 channel = 0; channel < 2; ++channel)
+		{
+			envelope[point][kFullBandKey][channel] = envelopeTotal[point][channel];
+		}
+	}
+
+	// ...while the band keys come from splitting the summed signal once, so instances that don't split still count
+	measuredBands = 0;
+	if (bandsMeasured && numBands > 1 && gridFrames > 0)
+	{
+		calculateBandEnergies(envelope);
+		measuredBands = numBands;
+	}
+	std::copy(&envelope[0][0][0], &envelope[0][0][0] + (kEnvelopePoints * kNumKeys * 2), &envelopeMS[0][0][0]);
+	const AkReal32 (&total)[kNumKeys][2] = envelope[kEnvelopePoints - 1];
+
+	// each instance's sidechain is that total with its own share taken back out, a row of slots at a time.
+	// Free slots go through the same arithmetic and are kept at 0 by their live bit.
+	for (size_t index = 0; index < pool.numChunks(); ++index)
+	{
+		InstancePool::Chunk* chunk = pool.chunk(index);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+		AkReal32 active[InstancePool::kSlotsPerChunk];
+		InstancePool::liveLanes(chunk->live.load(std::memory_order_acquire), active);
+		for (AkUInt16 key = 0; key < kNumKeys; ++key)
+		{
+			for (AkUInt16 channel = 0; channel < 2; ++channel)
+			{
+				AkReal32* AK_RESTRICT contribution = chunk->contribution[key][channel];
+				AkReal32* AK_RESTRICT others_ms = chunk->others_ms[key][channel];
+				AkReal32* AK_RESTRICT lastbuffer_looRMS = chunk->lastbuffer_looRMS[key][channel];
+				AkReal32* AK_RESTRICT newbuffer_looRMS = chunk->newbuffer_looRMS[key][channel];
+				const AkReal32* decay = chunk->decay[channel];
+				for (AkUInt16 lane = 0; lane < InstancePool::kSlotsPerChunk; ++lane)
+				{
+					AkReal32 others = AkMax(total[key][channel] - contribution[lane], 0.0f);
+					others_ms[lane] = ((others_ms[lane] * decay[lane]) + others) * active[lane];
+					lastbuffer_looRMS[lane] = newbuffer_looRMS[lane] * active[lane];
+					newbuffer_looRMS[lane] = sqrtf(others_ms[lane]);
+					contribution[lane] = 0.0f;
+				}
+			}
+		}
+	}
+}
+
+void SharedBuffer::setAutoThreshold(AkReal32 percentile, AkReal32 horizonSeconds)
+{
+	autoPercentile.store(percentile, std::memory_order_relaxed);
+	autoHorizon.store(horizonSeconds, std::memory_order_relaxed);
+	autoRequested.store(true, std::memory_order_relaxed);
+}
+
+void SharedBuffer::submitAnalysis()
+{
+	TIMELINE_SCOPE("submitAnalysis");
+	TickSummary summary = {};
+	summary.tick = tickCount;
+	summary.bandEpoch = bandEpoch;
+	summary.minPriority = (tickContributions == 0) ? 1.0f : tickMinPriority;
+	summary.maxPriority = (tickContributions == 0) ? 1.0f : tickMaxPriority;
+	summary.autoRequested = gridFrames > 0 && autoRequested.exchange(false, std::memory_order_relaxed);	// kept for a tick with something to measure
+	if (summary.autoRequested)
+	{
+		summary.autoPercentile = autoPercentile.load(std::memory_order_relaxed);
+		summary.horizonTicks = autoHorizon.load(std::memory_order_relaxed) * static_cast<AkReal32>(tickRate) / gridFrames;
+		summary.measuredBands = measuredBands;
+
+		// the level of a key is its louder channel, like the instances compare each channel against the threshold
+		summary.levelDB[kFullBandKey] = 20.0f * log10f(AkMax(newbuffer_mRMS[0], newbuffer_mRMS[1]));
+		for (AkUInt16 band = 0; band < Crossover::kMaxBands; ++band)
+		{
+			summary.levelDB[kFullBandKey + 1 + band] = 10.0f * log10f(AkMax(band_mMS[band][0], band_mMS[band][1]));
+		}
+	}
+	summaries.push(summary);								// full only while a worker thread is stalled, that tick is skipped
+
+	if (!AnalysisWorker::get().isRunning())
+	{
+		runAnalysis();
 	}
-	
-	return std::clamp(value, 0.0f, 1.0f);
 }
 
+void SharedBuffer::runAnalysis()
+{
+	TIMELINE_SCOPE("runAnalysis");
+	// one consumer at a time, the worker thread and a tick close can both get here around start() and stop()
+	if (analysisBusy.exchange(true, std::memory_order_acquire))
+	{
+		return;
+	}
+
+	TickSummary summary;
+	bool analyzed = false;
+	while (summaries.pop(summary))
+	{
+		analyze(summary);
+		analyzed = true;
+	}
+	if (analyzed)
+	{
+		analysisResults.publish(analysisScratch);
+	}
+	analysisBusy.store(false, std::memory_order_release);
+}
 
-void SharedBuffer::addToObjectList(AkUniqueID objectID)
+void SharedBuffer::analyze(const TickSummary& summary)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	auto it = std::find(objectList.begin(), objectList.end(), objectID);
-	if (it == objectList.end())
+	AnalysisResult& result = analysisScratch;
+	if (summary.bandEpoch != result.bandEpoch)
 	{
-		objectList.push_back(objectID);
+		// a new band layout, the old bands' levels mean nothing for the new ones
+		for (AkUInt16 key = kFullBandKey + 1; key < kNumKeys; ++key)
+		{
+			levelSketch[key].reset();
+			result.autoThresholdDB[key] = NAN;
+		}
+		result.bandEpoch = summary.bandEpoch;
+	}
+	result.minPriority = summary.minPriority;
+	result.maxPriority = summary.maxPriority;
+	if (!summary.autoRequested)
+	{
+		return;
+	}
+
+	for (AkUInt16 key = 0; key < kNumKeys; ++key)
+	{
+		// band keys only move on ticks where a multiband instance had the bus split the signal
+		if (key > kFullBandKey + summary.measuredBands)
+		{
+			continue;
+		}
+
+		LevelSketch& sketch = levelSketch[key];
+		sketch.setHorizon(summary.horizonTicks);
+		sketch.add(summary.levelDB[key]);
+
+		// published in half-dB steps, so the instances only rebuild their gain curves when it really moved
+		AkReal32 quantile = sketch.quantileDB(summary.autoPercentile / 100.0f);
+		if (std::isnan(result.autoThresholdDB[key]) || fabsf(quantile - result.autoThresholdDB[key]) >= 1.0f / LevelSketch::kBinsPerDB)
+		{
+			result.autoThresholdDB[key] = quantile;
+		}
 	}
 }
 
-void SharedBuffer::removeFromObjectList(AkUniqueID objectID)
+void SharedBuffer::applyAnalysis()
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	auto it = std::find(objectList.begin(), objectList.end(), objectID);
-	if (it != objectList.end())
+	TIMELINE_SCOPE("applyAnalysis");
+	AnalysisResult result;
+	if (!analysisResults.read(result))
 	{
-		objectList.erase(it);
+		return;												// the worker is publishing right now, keep the last results a tick longer
+	}
+
+	minPriority = result.minPriority;
+	maxPriority = result.maxPriority;
+	autoThresholdDB[kFullBandKey] = result.autoThresholdDB[kFullBandKey];
+	if (result.bandEpoch == bandEpoch)
+	{
+		// results from before a layout change would bring back the old bands' thresholds
+		std::copy(result.autoThresholdDB + kFullBandKey + 1, result.autoThresholdDB + kNumKeys, autoThresholdDB + kFullBandKey + 1);
 	}
 }
 
-void SharedBuffer::removeFromPriorityList(AkReal32 priority)
+void SharedBuffer::setCulling(AkReal32 belowDB, AkInt32 keep)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	auto it = std::find(priorityList.begin(), priorityList.end(), priority);
-	if (it != priorityList.end())
+	cullFraction.store((belowDB > -120.0f) ? powf(10.0f, belowDB / 10.0f) : 0.0f, std::memory_order_relaxed);	// -120 dB is off
+	cullKeep.store(static_cast<AkUInt16>(std::clamp<AkInt32>(keep, 0, 0xFFFF)), std::memory_order_relaxed);
+}
+
+void SharedBuffer::calculateCulling()
+{
+	TIMELINE_SCOPE("calculateCulling");
+	AkReal32 groupMS = 0.0f;
+	numCulled = 0;
+	numVirtual = 0;
+	AkReal32* blockMS = tickGrid->blockMS.get();			// a slot each, see registerInstance()
+	AkUInt32 numBlocks = 0;
+	for (size_t index = 0; index < pool.numChunks(); ++index)
+	{
+		const InstancePool::Chunk* chunk = pool.chunk(index);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+		const AkUInt32 live = chunk->live.load(std::memory_order_acquire);
+		for (AkUInt16 lane = 0; lane < InstancePool::kSlotsPerChunk; ++lane)
+		{
+			if ((live & (1u << lane)) != 0 && chunk->state[lane].virtualized)
+			{
+				numVirtual++;
+			}
+			else if ((live & (1u << lane)) != 0 && numBlocks < tickGrid->slots)
+			{
+				const AkReal32 laneMS = chunk->state[lane].blockMS;
+				groupMS += laneMS;
+				numCulled += (laneMS < cullFloorMS) ? 1 : 0;		// the floor they went by this tick
+				blockMS[numBlocks++] = laneMS;
+			}
+		}
+	}
+
+	// the floor for the next tick: a fraction of the whole group, raised to the level of the cullKeep-th loudest if there are more
+	AkReal32 floorMS = cullFraction.load(std::memory_order_relaxed) * groupMS;
+	const AkUInt16 keep = cullKeep.load(std::memory_order_relaxed);
+	if (keep > 0 && keep < numBlocks)
+	{
+		AkReal32* kept = blockMS + (keep - 1);
+		std::nth_element(blockMS, kept, blockMS + numBlocks, std::greater<AkReal32>());
+		floorMS = AkMax(floorMS, *kept);
+	}
+	cullFloorMS = floorMS;
+}
+
+void SharedBuffer::setBudget(AkReal32 microseconds)
+{
+	budgetNs.store(static_cast<AkUInt32>(AkMax(microseconds, 0.0f) * 1000.0f), std::memory_order_relaxed);
+}
+
+void SharedBuffer::calculateGovernor()
+{
+	TIMELINE_SCOPE("calculateGovernor");
+	const AkUInt32 costNs = tickCostNs.exchange(0, std::memory_order_relaxed);
+	const AkUInt32 budget = budgetNs.load(std::memory_order_relaxed);
+	if (budget == 0)
 	{
-		priorityList.erase(it);
+		// no budget, straight back to full quality
+		if (qualityTier != tier_full)
+		{
+			qualityTier = tier_full;
+			tierUps++;
+		}
+		ticksOver = ticksUnder = 0;
+		return;
+	}
+
+	ticksOver = (costNs > budget) ? ticksOver + 1 : 0;
+	ticksUnder = (costNs < budget * kStepUpHeadroom) ? AkMin(ticksUnder + 1, kStepUpTicks) : 0;
+
+	// the instances only pick the tier up at the start of their next buffer, where their ramps end, so switching never clicks
+	if (ticksOver >= kStepDownTicks && qualityTier + 1 < numTiers)
+	{
+		qualityTier++;
+		tierDowns++;
+		ticksOver = ticksUnder = 0;
+	}
+	else if (ticksUnder >= kStepUpTicks && qualityTier > tier_full)
+	{
+		qualityTier--;
+		tierUps++;
+		ticksOver = ticksUnder = 0;
+	}
+}
+
+void SharedBuffer::setDetector(bool truePeak)
+{
+	truePeakRequested.store(truePeak, std::memory_order_relaxed);
+}
+
+void SharedBuffer::calculateTruePeak()
+{
+	TIMELINE_SCOPE("calculateTruePeak");
+	const bool truePeak = truePeakRequested.load(std::memory_order_relaxed);
+	if (truePeak && !truePeakEnabled)
+	{
+		// start from silence rather than from peaks held before the group last switched to RMS
+		peakDetector.reset();
+		peak_mMS[0] = peak_mMS[1] = 0.0f;
+	}
+	truePeakEnabled = truePeak;
+	for (AkUInt16 channel = 0; channel < 2; ++channel)
+	{
+		crestFactor[0][channel] = crestFactor[kEnvelopePoints][channel];		// this tick starts where the last one ended
+	}
+	if (!truePeakEnabled || gridFrames == 0)
+	{
+		// the RMS detector, or a tick where every instance was culled: hold where it was
+		const AkReal32 held[2] = { truePeakEnabled ? crestFactor[0][0] : 1.0f, truePeakEnabled ? crestFactor[0][1] : 1.0f };
+		for (AkUInt16 point = 0; point <= kEnvelopePoints; ++point)
+		{
+			crestFactor[point][0] = held[0];
+			crestFactor[point][1] = held[1];
+		}
+		return;
+	}
+	if (truePeakSampleRate != tickRate)
+	{
+		peakDetector.setup(tickRate);
+		truePeakSampleRate = tickRate;
+	}
+
+	// the detector and the same moving mean square the instances use run a segment at a time, up to every envelope point
+	const AkUInt16 numChannels = gridChannels;
+	const AkUInt32 numFrames = gridFrames;
+	const AkReal32 msWeight = 1.0f / ((tickRate / 100) * numChannels);
+	AkUInt32 frame = 0;
+	for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+	{
+		const AkUInt32 pointFrame = envelopeFrame(point + 1, static_cast<AkUInt16>(numFrames));
+		const AkReal32* segment[2] = { tickGrid->channel(0) + frame, tickGrid->channel(numChannels - 1) + frame };
+		peakDetector.process(segment, numChannels, pointFrame - frame);
+		for (AkUInt16 channel = 0; channel < numChannels; ++channel)
+		{
+			AkReal32& currentMS = peak_mMS[channel];
+			for (AkUInt32 i = 0; i < pointFrame - frame; ++i)
+			{
+				currentMS += (segment[channel][i] * segment[channel][i] - currentMS) * msWeight;
+			}
+			const AkReal32 rms = sqrtf(currentMS);
+			crestFactor[point + 1][channel] = (rms > 1e-6f) ? AkMax(peakDetector.getPeak(channel) / rms, 1.0f) : 1.0f;
+		}
+		if (numChannels == 1)
+		{
+			crestFactor[point + 1][1] = crestFactor[point + 1][0];
+		}
+		frame = pointFrame;
+	}
+}
+
+void SharedBuffer::getLeaveOneOutRMS(AkUInt16 slot, AkReal32 lastRMS[kNumKeys][2], AkReal32 newRMS[kNumKeys][2])
+{
+	const InstancePool::Chunk& thisChunk = pool.chunkOf(slot);
+	const AkUInt16 lane = InstancePool::lane(slot);
+	for (AkUInt16 key = 0; key < kNumKeys; ++key)
+	{
+		for (AkUInt16 channel = 0; channel < 2; ++channel)
+		{
+			lastRMS[key][channel] = thisChunk.lastbuffer_looRMS[key][channel][lane];
+			newRMS[key][channel] = thisChunk.newbuffer_looRMS[key][channel][lane];
+		}
+	}
+}
+
+void SharedBuffer::publishSnapshot()
+{
+	TIMELINE_SCOPE("publishSnapshot");
+	AutoCompressorQuery::GroupInfo& info = snapshotScratch;
+	info.tick = tickCount;
+	info.sidechainDB[0] = 20.0f * log10f(AkMax(newbuffer_mRMS[0], 1e-10f));
+	info.sidechainDB[1] = 20.0f * log10f(AkMax(newbuffer_mRMS[1], 1e-10f));
+	info.numInstances = numInstances.load(std::memory_order_relaxed);
+	info.numCulled = numCulled;
+	info.numVirtual = numVirtual;
+	info.numReported = 0;
+	info.qualityTier = qualityTier;
+	info.tierDowns = tierDowns;
+	info.tierUps = tierUps;
+	for (size_t index = 0; index < pool.numChunks(); ++index)
+	{
+		InstancePool::Chunk* chunk = pool.chunk(index);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+
+		// every instance goes in its chunk's report, the first kMaxReportedInstances are listed in the snapshot too
+		InstancePool::Report& report = reportScratch;
+		report.live = chunk->live.load(std::memory_order_acquire);
+		for (AkUInt16 lane = 0; lane < InstancePool::kSlotsPerChunk; ++lane)
+		{
+			if ((report.live & (1u << lane)) == 0)
+			{
+				continue;
+			}
+			const InstancePool::State& state = chunk->state[lane];
+			AutoCompressorQuery::InstanceInfo& instance = report.instances[lane];
+			instance.gameObject = state.gameObject;
+			instance.audioNode = state.audioNode;
+			instance.priority = state.priority;
+			instance.numBands = state.numBands;
+			instance.culled = state.culled != 0;
+			instance.virtualized = state.virtualized != 0;
+			instance.gainReductionDB = 0.0f;
+			for (AkUInt16 band = 0; band < InstancePool::kMaxBands; ++band)
+			{
+				const bool used = band < state.numBands;
+				instance.bandGainReductionDB[band] = used ? AkMax(state.env_output[band][0], state.env_output[band][1]) : 0.0f;
+				instance.envState[band] = used ? state.env_state[band] : 0;
+				instance.gainReductionDB = AkMax(instance.gainReductionDB, instance.bandGainReductionDB[band]);
+			}
+			if (info.numReported < AutoCompressorQuery::kMaxReportedInstances)
+			{
+				info.instances[info.numReported++] = instance;
+			}
+		}
+		chunk->report.publish(report);
+	}
+	snapshot.publish(info);
+}
+
+bool SharedBuffer::readGameObject(AkGameObjectID gameObject, AutoCompressorQuery::InstanceInfo& info) const
+{
+	// the chunks' reports rather than the snapshot, which only lists the first kMaxReportedInstances
+	InstancePool::Report report;
+	bool found = false;
+	for (size_t index = 0; index < pool.numChunks(); ++index)
+	{
+		const InstancePool::Chunk* chunk = pool.chunk(index);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+		if (!chunk->report.read(report))
+		{
+			return false;
+		}
+		for (AkUInt16 lane = 0; lane < InstancePool::kSlotsPerChunk; ++lane)
+		{
+			const AutoCompressorQuery::InstanceInfo& instance = report.instances[lane];
+			if ((report.live & (1u << lane)) != 0 && instance.gameObject == gameObject && (!found || instance.gainReductionDB > info.gainReductionDB))
+			{
+				info = instance;
+				found = true;
+			}
+		}
 	}
+	return found;
 }
@@ -4,55 +4,230 @@
 #include <mutex>
 #include <algorithm>
 #include <atomic>
-#include <iostream>
-#include <string>
-#include <sstream>
-#include <shared_mutex>
+#include <cmath>
+#include <functional>
+#include <memory>
 #include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include "Crossover.h"
+#include "GainReductionQuery.h"
+#include "InstancePool.h"
+#include "LevelSketch.h"
+#include "Seqlock.h"
+#include "SpscRing.h"
+#include "Timeline.h"
+#include "TruePeak.h"
 
+// Members are grouped by who writes them. The tick counter every instance bumps, what the tick close publishes for
+// everyone to read, what the instances ask of the tick close, and the mutex each start their own cache line.
+// Nothing an instance does from Execute or TimeSkip takes the mutex: each leaves its share of the tick in its own slot and
+// the instance closing the tick sums them. Only Init takes it, to grow the grid.
 class SharedBuffer
 {
 public:
 
-	std::vector<AkUniqueID> objectList;
-	std::vector<std::vector<AkReal32>> sharedBuffer;		// 2-D array imitating a buffer's channels (outer vector) and frames (inner vector)
-	std::atomic<AkInt16> numBuffersCalculated = 0;
-	std::vector<AkReal32> priorityList;						// used for calculating min and max Priority, of previous buffer
-	//std::atomic<AkInt16> signalCounter = 0;
+	static constexpr AkUInt16 kNumKeys = InstancePool::kNumKeys;
+	static constexpr AkUInt16 kFullBandKey = 0;
+	static constexpr AkUInt16 kEnvelopePoints = InstancePool::kEnvelopePoints;
 
-	AkReal32 minPriority = 1.0f;							// Current minimum of Priority ranks
+	// How closely the instances follow the sidechain, stepped down by calculateGovernor when the group goes over its CPU budget
+	enum QualityTier
+	{
+		tier_full = 0,										// gain computer and envelope every frame
+		tier_subBlock,										// every AutoCompressorFX::kSubBlockFrames, the gain ramps linearly in between
+		tier_block,											// once per envelope point
+		numTiers
+	};
+
+	// frames into a tick of the given length where envelope point (1 to kEnvelopePoints) falls, the last one is the end of the tick
+	static AkUInt16 envelopeFrame(AkUInt16 point, AkUInt16 frames) { return static_cast<AkUInt16>((point * frames) / kEnvelopePoints); }
+
+	alignas(kCacheLineSize) std::atomic<AkInt16> numBuffersCalculated = 0;
+	std::atomic<AkUInt32> tickCostNs = 0;					// what the instances spent on this tick so far, and the last tick close
+
+	alignas(kCacheLineSize) std::atomic<AkUInt16> numInstances = 0;	// number of active slots
+	AkReal32 minPriority = 1.0f;							// Current minimum of Priority ranks, from applyAnalysis
 	AkReal32 maxPriority = 1.0f;							// Current maximum of Priority ranks
-	
 	AkReal32 lastbuffer_mRMS[2] = { 0.0f, 0.0f };			// The moving RMS of the last L and R samples of the previous buffer
 	AkReal32 newbuffer_mRMS[2] = { 0.0f, 0.0f };
-	AkReal32 diff_mRMS[2] = { 0.0f, 0.0f };					// the "slope" of the RMS of the previous buffer
-	AkReal32 lastRMSAdded[2] = { 0.1f, 0.1f };				// for debugging?
-	
-
-	std::string errorMsg = "Default Error Message";
-	
-	void resetSharedBufferAndPriorityList();				// resets everything, including numBuffersCalculated
-	void resizeSharedBuffer(AkAudioBuffer* sourceBuffer);
-	void addToSharedBuffer(AkAudioBuffer* sourceBuffer);
-	void calculatemRMS(AkUInt32 frames10ms);				// in linear.  applies calcs to newbuffer_mRMS
-	void addToPriorityList(AkReal32 priority);
-	void calculatePriorityMinMax();							// applies calcs to minPriority and maxPriority
+	AkReal32 autoThresholdDB[kNumKeys] = { NAN, NAN, NAN, NAN, NAN };	// percentile of each key's level, NaN until the group was heard, from applyAnalysis
+	AkReal32 cullFloorMS = 0.0f;							// instances whose block mean square is under this sit the tick out
+	AkUInt16 numCulled = 0;									// how many did on the last tick
+	AkUInt16 numVirtual = 0;								// and how many sat it out in TimeSkip, kept out of numCulled and the cullKeep ranking
+	AkUInt32 tickCount = 0;									// ticks closed so far, for the trace
+	AkUInt8 qualityTier = tier_full;
+	AkUInt32 tierDowns = 0;									// quality tier changes so far, for AutoCompressorQuery
+	AkUInt32 tierUps = 0;
+	AkReal32 envelopeMS[kEnvelopePoints][kNumKeys][2] = {};	// what the last tick added to the bus's moving mean square by each envelope point, per key
+	AkReal32 crestFactor[kEnvelopePoints + 1][2] = { { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 } };	// true peak over RMS of the summed signal at the start of the last tick and each of its points, 1 while the group detects RMS
+
+	alignas(kCacheLineSize) InstancePool pool;				// per-slot state of the registered instances, slots handed out by registerInstance() get reused
+
+	void resetSharedBuffer();								// silences what this tick used of the grid, from the tick close
+	void addToSharedBuffer(AkUInt16 slot, AkAudioBuffer* sourceBuffer, AkUInt32 sampleRate);	// into the slot's row, as it is, for sumContributions()
+	void sumContributions();								// O(N), first in the tick close: the rows onto the grid, the priority range and the full band envelope
+	void calculatemRMS();									// in linear.  applies calcs to newbuffer_mRMS
 	float getRatioPercentile(AkReal32 priority) const;		// returns new Ratio based on minPrio and maxPrio, a percentile in decimal form
-	void addToObjectList(AkUniqueID objectID);
-	void removeFromObjectList(AkUniqueID objectID);
-	void removeFromPriorityList(AkReal32 priority);
+	AkUInt16 registerInstance(AkUInt32 sampleRate, AkUInt16 maxFrames);	// the slot the instance should use for as long as it stays on this bus, InstancePool::kNoSlot when the bus is full
+	AkUInt16 tryRegisterInstance(AkUInt16 maxFrames, const InstancePool::State& carried);	// registerInstance() for a Group change from Execute, with the State it brings, never locks or allocates, and never changes the bus's rate. kNoSlot when it would have to
+	void reserveForMove(AkUInt32 sampleRate, AkUInt16 maxFrames);	// sizes the grid for an instance that may move here later, and for the spare chunks
+	void unregisterInstance(AkUInt16 slot);
+	InstancePool::State* getInstanceState(AkUInt16 slot);	// stays valid until the slot is unregistered
+	void addContribution(AkUInt16 slot, const AkReal32 envelope[kEnvelopePoints][kNumKeys][2], const AkReal32 decay[2]);	// what this tick added to the instance's moving mean square by each point
+	void setBandLayout(AkUInt16 bands, const AkReal32 frequencies[Crossover::kMaxBands - 1]);	// multiband instances call this every tick, the tick close applies it when something changed
+	void calculateLeaveOneOut();							// O(N): every slot gets the bus total minus its own contribution
+	void setAutoThreshold(AkReal32 percentile, AkReal32 horizonSeconds);	// auto threshold instances call this every tick, whoever calls it last wins
+	void submitAnalysis();									// O(1): hands this tick's levels and priority range to the analysis, see AnalysisWorker
+	void applyAnalysis();									// O(1): applies the latest analysis results to minPriority, maxPriority and autoThresholdDB
+	void runAnalysis();										// drains the summaries, on the worker thread or right from submitAnalysis() when there is none
+	void setCulling(AkReal32 belowDB, AkInt32 keep);		// instances call this when their culling parameters change, whoever calls it last wins
+	void calculateCulling();								// O(N): counts this tick's culled instances and applies calcs to cullFloorMS
+	void setDetector(bool truePeak);						// instances call this when their detector parameter changes, whoever calls it last wins
+	void setBudget(AkReal32 microseconds);					// instances call this when their CPU budget changes, whoever calls it last wins
+	void calculateGovernor();								// O(1): weighs this tick's cost against the budget and applies calcs to qualityTier
+	void calculateTruePeak();								// O(frames), once per group: applies calcs to crestFactor
+	void getLeaveOneOutRMS(AkUInt16 slot, AkReal32 lastRMS[kNumKeys][2], AkReal32 newRMS[kNumKeys][2]);
+	void publishSnapshot();									// O(N): what AutoCompressorQuery reads, from the tick close
+	bool readSnapshot(AutoCompressorQuery::GroupInfo& info) const { return snapshot.read(info); }	// any thread, never takes mtx
+	bool readGameObject(AkGameObjectID gameObject, AutoCompressorQuery::InstanceInfo& info) const;	// O(N), any thread, never takes mtx: the most ducked instance on gameObject
 
 private:
-	std::mutex mtx;
-	std::shared_mutex smtx;
+	void applyBandLayout();									// what setBandLayout() asked for, from sumContributions()
+	void calculateBandEnergies(AkReal32 envelope[kEnvelopePoints][kNumKeys][2]);	// splits the summed signal into the band keys
+	void reserveGrid(AkUInt32 frames, AkUInt32 slots);		// swaps in a bigger grid when this one is too short or has too few slots, mtx must be held
+
+	// The summed signal lives on a time grid at the sample rate of the first instance to register on an empty bus from Init. Contributions at
+	// other rates are resampled onto it, and each covers the grid for as long as its buffer lasts, from the start of the tick.
+	// The grid only ever grows, from registerInstance(): a tick close on another thread may still be summing onto the old
+	// one, so it is kept rather than freed, and the close only looks at the grid again on the next tick.
+	struct Grid
+	{
+		AkUInt32 frames = 0;
+		AkUInt32 slots = 0;
+		std::unique_ptr<AkReal32[]> samples;				// left then right, frames each
+		std::unique_ptr<AkReal32[]> blockMS;				// a block mean square per slot, for calculateCulling()'s partial selection
+		AkReal32* channel(AkUInt16 channel) { return samples.get() + (static_cast<size_t>(channel) * frames); }
+	};
+	std::atomic<Grid*> grid = nullptr;						// the latest
+	std::vector<std::unique_ptr<Grid>> grids;				// every grid so far, mtx must be held
+	Grid* tickGrid = nullptr;								// the one this tick close uses, taken by sumContributions()
+	std::atomic<AkUInt32> gridRate = 48000;				// only registerInstance() sets it, under mtx
+	AkUInt32 tickRate = 48000;								// the one this tick close uses, taken by sumContributions()
+	AkUInt32 gridFrames = 0;								// frames of the grid this tick covers, the longest contribution
+	AkUInt16 gridChannels = 0;								// 1 when only mono instances contributed
+
+	static constexpr AkUInt16 kBandChunkFrames = 64;		// the grid goes through the crossover this many frames at a time
+	Crossover crossover;									// splits the grid once per tick for the band keys, so it costs the same for 1 or 100 instances
+	AkUInt16 numBands = 1;
+	AkReal32 crossoverFrequencies[Crossover::kMaxBands - 1] = { 0.0f, 0.0f, 0.0f };
+	AkUInt32 crossoverSampleRate = 0;
+	bool bandsMeasured = false;								// a multiband instance asked for band keys this tick, from sumContributions()
+	AkReal32 band_mMS[Crossover::kMaxBands][2] = {};		// moving mean square of each band of the summed signal
+	AkReal32 bandScratch[Crossover::kMaxBands][2][kBandChunkFrames];
+	AkUInt16 measuredBands = 0;								// bands whose band_mMS moved this tick, 0 when the bus didn't split
+	AkReal32 envelopeTotal[kEnvelopePoints][2] = {};		// full band envelope of this tick, the sum of every contribution
+	AkReal32 tickMinPriority = 1.0f;						// range of the priorities of this tick's contributions
+	AkReal32 tickMaxPriority = 1.0f;
+	AkUInt16 tickContributions = 0;
+	AkUInt32 bandEpoch = 0;									// bumped when the band layout changes, the analysis starts the band keys over
+
+	// What the instances ask of the tick close, whoever asks last wins
+	alignas(kCacheLineSize) std::atomic<bool> bandsRequested = false;	// a multiband instance asked for band keys this tick
+	std::atomic<AkUInt16> requestedBands = 1;
+	std::atomic<AkReal32> requestedFrequencies[Crossover::kMaxBands - 1] = {};
+	std::atomic<bool> autoRequested = false;				// an auto threshold instance ran this tick
+	std::atomic<AkReal32> autoPercentile = 50.0f;
+	std::atomic<AkReal32> autoHorizon = 30.0f;				// in seconds
+	std::atomic<AkReal32> cullFraction = 0.0f;				// of the group's mean square, 0 culls nothing
+	std::atomic<AkUInt16> cullKeep = 0;						// only the loudest this many take part, 0 keeps everyone
+	std::atomic<bool> truePeakRequested = false;
+	std::atomic<AkUInt32> budgetNs = 0;						// per tick, 0 keeps the group at full quality
+
+	// Peaks can't be summed or taken back out like mean squares, so the true-peak detector runs on the summed signal only and the
+	// group shares its crest factor: every instance scales its own leave-one-out RMS by it, see AutoCompressorFX::buildSidechain.
+	TruePeak peakDetector;
+	bool truePeakEnabled = false;
+	AkUInt32 truePeakSampleRate = 0;
+	AkReal32 peak_mMS[2] = { 0.0f, 0.0f };					// moving mean square of the summed signal the crest factor is taken against
+
+	// The governor steps down as soon as two ticks in a row went over budget, and back up only after a second's worth of ticks
+	// well under it, so a tier that fits never flaps with the one above it
+	static constexpr AkUInt16 kStepDownTicks = 2;
+	static constexpr AkUInt16 kStepUpTicks = 100;
+	static constexpr AkReal32 kStepUpHeadroom = 0.5f;		// of the budget, the tier above costs more
+	AkUInt16 ticksOver = 0;
+	AkUInt16 ticksUnder = 0;
+
+	// What the tick close hands to the analysis, and what comes back. Everything past the ring is only touched by whoever
+	// drains it, the worker thread or the tick close when there is none, one at a time.
+	struct TickSummary
+	{
+		AkUInt32 tick;
+		AkUInt32 bandEpoch;
+		AkReal32 minPriority;
+		AkReal32 maxPriority;
+		bool autoRequested;
+		AkReal32 autoPercentile;
+		AkReal32 horizonTicks;
+		AkReal32 levelDB[kNumKeys];							// the louder channel of each key
+		AkUInt16 measuredBands;
+	};
+	struct AnalysisResult
+	{
+		AkUInt32 bandEpoch = 0;
+		AkReal32 minPriority = 1.0f;
+		AkReal32 maxPriority = 1.0f;
+		AkReal32 autoThresholdDB[kNumKeys] = { NAN, NAN, NAN, NAN, NAN };
+	};
+	void analyze(const TickSummary& summary);
+
+	SpscRing<TickSummary, 16> summaries;					// the tick closes of one group never overlap, so they make a single producer
+	Seqlock<AnalysisResult> analysisResults;
+	alignas(kCacheLineSize) std::atomic<bool> analysisBusy = false;
+	AnalysisResult analysisScratch;
+	LevelSketch levelSketch[kNumKeys];						// level of the summed signal per key, for the auto threshold
+
+	AutoCompressorQuery::GroupInfo snapshotScratch = {};	// filled by publishSnapshot, then copied under the seqlock in one go
+	InstancePool::Report reportScratch = {};				// the same for each chunk's report
+	Seqlock<AutoCompressorQuery::GroupInfo> snapshot;
+
+	alignas(kCacheLineSize) std::mutex mtx;					// from Init only, see above
+	using BusLock = TimelineLockGuard<std::mutex>;			// a std::lock_guard, that also shows its waits on the timeline when there is one
 };
 
 class GlobalManager
 {
 public:
-	static std::shared_ptr<SharedBuffer> getGlobalSharedBuffer()
+	static constexpr AkInt32 kNumGroups = 16;
+
+	// One sidechain bus per group, instances only duck against the ones sharing their group.
+	// The busses live as long as the process, so instances keep a plain pointer to theirs.
+	static SharedBuffer* getGlobalSharedBuffer(AkInt32 group = 0)
+	{
+		static SharedBuffer globalSharedBuffers[kNumGroups];
+		return &globalSharedBuffers[std::clamp(group, 0, kNumGroups - 1)];
+	}
+
+	// The longest buffer an instance may get, what the busses size their storage for. The sound engine tells instances through
+	// their plug-in context, hosts that create them without one (the stand-in host) set it here before Init.
+	static constexpr AkUInt16 kDefaultMaxBufferLength = 1024;	// the sound engine's default
+	static AkUInt16 getMaxBufferLength() { return maxBufferLength(); }
+	static void setMaxBufferLength(AkUInt16 frames) { maxBufferLength() = frames; }
+
+	// A Group change during playback moves the instance from Execute, where it can't lock or allocate. Init sets up what the
+	// move needs on every bus ahead of time: a grid long enough for the instance, and the spare chunks of InstancePool.
+	static void reserveForMoves(AkUInt32 sampleRate, AkUInt16 maxFrames)
+	{
+		InstancePool::reserveSpares(maxFrames);
+		for (AkInt32 group = 0; group < kNumGroups; ++group)
+		{
+			getGlobalSharedBuffer(group)->reserveForMove(sampleRate, maxFrames);
+		}
+	}
+
+private:
+	static AkUInt16& maxBufferLength()
 	{
-		static std::shared_ptr<SharedBuffer> globalSharedBuffer = std::make_shared<SharedBuffer>();
-		return globalSharedBuffer;
+		static AkUInt16 frames = kDefaultMaxBufferLength;
+		return frames;
 	}
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "SlidingMax.h"
+
+#include <algorithm>
+
+void SlidingMax::setWindow(AkUInt32 values)
+{
+	// a shorter window lets its older entries go on the next push
+	window = std::clamp<AkUInt32>(values, 1, kCapacity);
+}
+
+AkReal32 SlidingMax::push(AkReal32 value)
+{
+	// the smaller values at the back can never be the maximum again, this one outlives them
+	while (size > 0 && entries[(head + size - 1) & (kCapacity - 1)].value <= value)
+	{
+		size--;
+	}
+
+	// the front one slid out of the window, at most one does per push once the window stopped shrinking
+	while (size > 0 && count - entries[head].index >= window)
+	{
+		head = (head + 1) & (kCapacity - 1);
+		size--;
+	}
+
+	entries[(head + size) & (kCapacity - 1)] = { count, value };
+	size++;
+	count++;
+	return entries[head].value;
+}
+
+void SlidingMax::reset()
+{
+	head = 0;
+	size = 0;
+	count = 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+// Maximum of the last few values of a stream, the peak hold of a detector that shouldn't release between syllables.
+// A monotonic deque: it only keeps the values that can still become the maximum, each one smaller than the one before it, so
+// the front is always the answer. A new value drops every smaller one off the back first, and every value leaves the deque
+// once at most, which makes push() O(1) amortized whatever the window. The deque lives in a ring of kCapacity entries, the
+// most a window can hold, since it never has more entries than the window has values.
+class SlidingMax
+{
+public:
+	static constexpr AkUInt32 kCapacity = 1024;				// a power of two, the indices wrap with a mask. The longest Hold, 0.5 s, is 750 blocks at 96 kHz
+
+	void setWindow(AkUInt32 values);						// how many of the latest values the maximum covers, 1 to kCapacity
+	AkReal32 push(AkReal32 value);							// adds a value, then returns the maximum of the window ending on it
+	AkReal32 max() const { return (size > 0) ? entries[head].value : 0.0f; }
+	void reset();
+
+private:
+	struct Entry
+	{
+		AkUInt32 index;										// when the value came in, counting every push
+		AkReal32 value;
+	};
+
+	Entry entries[kCapacity];
+	AkUInt32 head = 0;										// the oldest entry, and the largest value
+	AkUInt32 size = 0;
+	AkUInt32 count = 0;										// values pushed so far
+	AkUInt32 window = 1;
+};
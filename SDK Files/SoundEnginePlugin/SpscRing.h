@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// Bounded queue between exactly one producer and one consumer, wait-free on both sides.
+// Each side owns one index and only reads the other's, so a push or a pop is a few loads and one store, and never retries.
+// A full ring refuses the push rather than overwrite what the consumer hasn't read yet.
+template <typename T, size_t Capacity>
+class SpscRing
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "the indices wrap with a mask");
+	static_assert(std::is_trivially_copyable<T>::value, "the slots are copied in and out while the other side runs");
+
+public:
+	bool push(const T& value)								// the producer, false when full
+	{
+		const size_t write = writeIndex.load(std::memory_order_relaxed);
+		if (write - readIndex.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+		slots[write & (Capacity - 1)] = value;
+		writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T& value)										// the consumer, false when empty
+	{
+		const size_t read = readIndex.load(std::memory_order_relaxed);
+		if (read == writeIndex.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		value = slots[read & (Capacity - 1)];
+		readIndex.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	alignas(64) std::atomic<size_t> writeIndex = 0;			// a cache line each, the two sides never write the same one
+	alignas(64) std::atomic<size_t> readIndex = 0;
+	alignas(64) T slots[Capacity];
+};
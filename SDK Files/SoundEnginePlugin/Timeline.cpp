@@ -0,0 +1,114 @@
+#include "Timeline.h"
+
+#if defined(AUTOCOMPRESSOR_TIMELINE)
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	thread_local AkUInt32 threadIndex = ~0u;		// the buffer this thread claimed, none yet
+}
+
+Timeline& Timeline::get()
+{
+	static Timeline timeline;
+	return timeline;
+}
+
+void Timeline::start(AkUInt32 threads, AkUInt32 eventsPerThread)
+{
+	std::call_once(allocated, [&]()
+	{
+		numBuffers = threads;
+		capacity = eventsPerThread;
+		buffers.reset(new ThreadBuffer[numBuffers]);
+		for (AkUInt32 i = 0; i < numBuffers; ++i)
+		{
+			buffers[i].events.reset(new TimelineEvent[capacity]);
+		}
+		origin = std::chrono::steady_clock::now();
+	});
+	recording.store(true, std::memory_order_release);
+}
+
+void Timeline::stop()
+{
+	recording.store(false, std::memory_order_release);
+}
+
+AkUInt64 Timeline::now() const
+{
+	return static_cast<AkUInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+}
+
+void Timeline::record(const TimelineEvent& event)
+{
+	if (threadIndex == ~0u)
+	{
+		threadIndex = numThreads.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (threadIndex >= numBuffers)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// only this thread writes its buffer, the readers see an event once its count is stored
+	ThreadBuffer& buffer = buffers[threadIndex];
+	const AkUInt32 count = buffer.count.load(std::memory_order_relaxed);
+	if (count >= capacity)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	buffer.events[count] = event;
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void Timeline::forEach(const std::function<void(AkUInt32 thread, const TimelineEvent& event)>& visit) const
+{
+	const AkUInt32 threads = std::min(numThreads.load(std::memory_order_relaxed), numBuffers);
+	for (AkUInt32 thread = 0; thread < threads; ++thread)
+	{
+		const AkUInt32 count = buffers[thread].count.load(std::memory_order_acquire);
+		for (AkUInt32 i = 0; i < count; ++i)
+		{
+			visit(thread, buffers[thread].events[i]);
+		}
+	}
+}
+
+bool Timeline::writeChromeTrace(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	// complete events ("X") in microseconds, one track per thread that recorded, in the order the threads first did
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":%u},\"traceEvents\":[\n", droppedEvents());
+	const AkUInt32 threads = std::min(numThreads.load(std::memory_order_relaxed), numBuffers);
+	for (AkUInt32 thread = 0; thread < threads; ++thread)
+	{
+		fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}},\n", thread, thread);
+	}
+	bool first = true;
+	forEach([&](AkUInt32 thread, const TimelineEvent& event)
+	{
+		fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", first ? "" : ",\n", event.name, thread,
+			event.startNs / 1000.0, event.durationNs / 1000.0);
+		if (event.group >= 0)
+		{
+			fprintf(file, ",\"args\":{\"group\":%d,\"slot\":%u,\"tick\":%u}", event.group, event.slot, event.tick);
+		}
+		fputc('}', file);
+		first = false;
+	});
+	// the metadata events end with a comma, so an empty timeline still needs an element after them
+	fprintf(file, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"AutoCompressor\"}}\n]}\n", first ? "" : ",\n");
+	return fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "InstancePool.h"					// kCacheLineSize
+
+// Scoped markers of what every thread does inside the plug-in, for a timeline of the ticks in chrome://tracing or Perfetto:
+// when each instance ran, which one closed its group's tick, and how long any of them waited on a bus's mutex.
+// Compiled in only when AUTOCOMPRESSOR_TIMELINE is defined, TIMELINE_SCOPE is an empty statement and TimelineLockGuard a
+// std::lock_guard otherwise.
+// Every thread appends to a buffer of its own, claimed with one atomic the first time it records, so recording never waits
+// on another thread and never allocates. A thread whose buffer is full, or that came past the last buffer, drops its events
+// and counts them.
+
+#if defined(AUTOCOMPRESSOR_TIMELINE)
+
+struct TimelineEvent
+{
+	const char* name;						// a string literal, only the pointer is kept
+	AkUInt64 startNs;						// since Timeline::start()
+	AkUInt32 durationNs;
+	AkInt32 group;							// -1 when the event isn't about one instance
+	AkUInt16 slot;
+	AkUInt32 tick;							// the group's tick counter
+};
+
+class Timeline
+{
+public:
+	static Timeline& get();
+
+	void start(AkUInt32 threads = 16, AkUInt32 eventsPerThread = 1 << 16);		// allocates every buffer, before the audio threads run. Once per process
+	void stop();
+	bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+	AkUInt64 now() const;													// ns since start()
+	void record(const TimelineEvent& event);								// audio threads, wait-free
+	void forEach(const std::function<void(AkUInt32 thread, const TimelineEvent& event)>& visit) const;	// what was recorded so far, any thread
+	bool writeChromeTrace(const char* path) const;							// forEach as trace-event JSON. False if the file can't be written
+	AkUInt32 droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct ThreadBuffer
+	{
+		alignas(kCacheLineSize) std::atomic<AkUInt32> count = 0;			// events written, each one published by the store that counts it
+		std::unique_ptr<TimelineEvent[]> events;
+	};
+
+	std::unique_ptr<ThreadBuffer[]> buffers;
+	AkUInt32 numBuffers = 0;
+	AkUInt32 capacity = 0;													// events per buffer
+	std::atomic<AkUInt32> numThreads = 0;									// buffers claimed, and threads turned away past numBuffers
+	std::atomic<AkUInt32> dropped = 0;
+	std::atomic<bool> recording = false;
+	std::chrono::steady_clock::time_point origin;
+	std::once_flag allocated;
+};
+
+// Records the time from its construction to the end of its scope, when the timeline was recording as it started
+class TimelineScope
+{
+public:
+	explicit TimelineScope(const char* name, AkInt32 group = -1, AkUInt16 slot = 0, AkUInt32 tick = 0)
+		: active(Timeline::get().isRecording())
+	{
+		if (active)
+		{
+			event = { name, Timeline::get().now(), 0, group, slot, tick };
+		}
+	}
+	~TimelineScope()
+	{
+		if (active)
+		{
+			event.durationNs = static_cast<AkUInt32>(Timeline::get().now() - event.startNs);
+			Timeline::get().record(event);
+		}
+	}
+	TimelineScope(const TimelineScope&) = delete;
+	TimelineScope& operator=(const TimelineScope&) = delete;
+
+private:
+	TimelineEvent event;
+	bool active;
+};
+
+#define TIMELINE_CONCAT_(a, b) a##b
+#define TIMELINE_CONCAT(a, b) TIMELINE_CONCAT_(a, b)
+#define TIMELINE_SCOPE(...) TimelineScope TIMELINE_CONCAT(timelineScope, __LINE__)(__VA_ARGS__)
+
+// A lock_guard that puts the time it spent waiting on the timeline, when the mutex wasn't free. Uncontended, it costs a try_lock
+template <typename Mutex>
+class TimelineLockGuard
+{
+public:
+	explicit TimelineLockGuard(Mutex& mutex) : mutex(mutex)
+	{
+		if (!mutex.try_lock())
+		{
+			TIMELINE_SCOPE("wait bus mutex");
+			mutex.lock();
+		}
+	}
+	~TimelineLockGuard() { mutex.unlock(); }
+	TimelineLockGuard(const TimelineLockGuard&) = delete;
+	TimelineLockGuard& operator=(const TimelineLockGuard&) = delete;
+
+private:
+	Mutex& mutex;
+};
+
+#else
+
+#define TIMELINE_SCOPE(...) do {} while (false)
+
+template <typename Mutex>
+using TimelineLockGuard = std::lock_guard<Mutex>;
+
+#endif
@@ -0,0 +1,183 @@
+#include "TraceRecorder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr AkUInt32 kTraceVersion = 1;
+	constexpr auto kDrainInterval = std::chrono::milliseconds(10);
+	constexpr size_t kDrainBatch = 256;				// records per fwrite
+}
+
+TraceRecorder& TraceRecorder::get()
+{
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+TraceRecorder::~TraceRecorder()
+{
+	stop();
+}
+
+bool TraceRecorder::start(const char* path, AkUInt32 capacity)
+{
+	std::lock_guard<std::mutex> lock(controlMutex);
+	if (file != nullptr)
+	{
+		return false;
+	}
+	file = fopen(path, "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	if (!cells)
+	{
+		size_t size = 1;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		cells.reset(new Cell[size]);
+		for (size_t i = 0; i < size; ++i)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		mask = size - 1;
+	}
+
+	TraceFileHeader header = {};
+	memcpy(header.magic, "ACTRACE", 8);
+	header.version = kTraceVersion;
+	header.recordSize = sizeof(TraceRecord);
+	fwrite(&header, sizeof(header), 1, file);
+
+	dropped.store(0, std::memory_order_relaxed);
+	draining.store(true, std::memory_order_relaxed);
+	drainThread = std::thread(&TraceRecorder::drain, this);
+	recording.store(true, std::memory_order_release);
+	return true;
+}
+
+void TraceRecorder::stop()
+{
+	std::lock_guard<std::mutex> lock(controlMutex);
+	if (file == nullptr)
+	{
+		return;
+	}
+	recording.store(false, std::memory_order_release);
+	draining.store(false, std::memory_order_release);
+	drainThread.join();
+	fclose(file);
+	file = nullptr;
+}
+
+void TraceRecorder::startFromEnvironment()
+{
+	std::call_once(environmentChecked, [this]()
+	{
+		const char* path = getenv("AUTOCOMPRESSOR_TRACE");
+		if (path != nullptr && path[0] != '\0')
+		{
+			start(path);
+		}
+	});
+}
+
+void TraceRecorder::push(const TraceRecord& record)
+{
+	// bounded MPMC queue (D. Vyukov): a cell is free for position pos when its sequence is pos, and holds a record when it is pos + 1
+	size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	Cell* cell;
+	for (;;)
+	{
+		cell = &cells[pos & mask];
+		const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+		if (difference == 0)
+		{
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);		// full, the drain thread is behind
+			return;
+		}
+		else
+		{
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	cell->record = record;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::pop(TraceRecord& record)
+{
+	Cell& cell = cells[dequeuePos & mask];
+	if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+	{
+		return false;
+	}
+	record = cell.record;
+	cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+	dequeuePos++;
+	return true;
+}
+
+void TraceRecorder::drain()
+{
+#if defined(__linux__)
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);	// the thread's nice value, audio threads come first
+#endif
+
+	TraceRecord batch[kDrainBatch];
+	bool running = true;
+	while (running)
+	{
+		running = draining.load(std::memory_order_acquire);		// read before the last pass, so nothing pushed before stop() is left behind
+
+		size_t count = 0;
+		const AkUInt32 lost = dropped.exchange(0, std::memory_order_relaxed);
+		if (lost > 0)
+		{
+			batch[count] = TraceRecord();
+			batch[count].kind = TraceRecord::kind_dropped;
+			batch[count].count = lost;
+			count++;
+		}
+		for (;;)
+		{
+			while (count < kDrainBatch && pop(batch[count]))
+			{
+				count++;
+			}
+			if (count == 0)
+			{
+				break;
+			}
+			fwrite(batch, sizeof(TraceRecord), count, file);
+			count = 0;
+		}
+
+		if (running)
+		{
+			std::this_thread::sleep_for(kDrainInterval);
+		}
+	}
+	fflush(file);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "InstancePool.h"					// kCacheLineSize, Crossover::kMaxBands
+
+// One record of a trace file. Files start with a TraceFileHeader and are followed by records as they are in memory (little-endian).
+struct TraceRecord
+{
+	enum Kind : AkUInt8
+	{
+		kind_bus = 0,			// the tick close of a group, written after the instances of that tick
+		kind_instance,			// one instance's Execute
+		kind_dropped			// the ring was full, count tells how many records were lost
+	};
+
+	AkUInt8 kind;
+	AkUInt8 group;
+	AkUInt16 slot;				// the instance's slot on the bus, slots get reused when voices end
+	AkUInt32 tick;				// the group's tick counter, which ties instances to their bus record
+	union
+	{
+		struct
+		{
+			AkReal32 sidechainRMS[2];				// newbuffer_mRMS, linear
+			AkReal32 minPriority;
+			AkReal32 maxPriority;
+			AkUInt32 sampleRate;
+			AkUInt16 frames;
+			AkUInt16 numInstances;
+			AkUInt16 numCulled;
+		} bus;
+		struct
+		{
+			AkReal32 priority;
+			AkReal32 percentile;					// of the ratio, from getRatioPercentile
+			AkReal32 gainReductionDB[Crossover::kMaxBands];	// positive, the louder channel of each band
+			AkUInt8 envState[Crossover::kMaxBands];
+			AkUInt8 numBands;
+			AkUInt8 culled;
+		} instance;
+		AkUInt32 count;
+	};
+};
+static_assert(sizeof(TraceRecord) == 40, "the trace file format depends on the record size");
+
+struct TraceFileHeader
+{
+	char magic[8];				// "ACTRACE" and a 0
+	AkUInt32 version;
+	AkUInt32 recordSize;
+};
+
+// Opt-in recorder of the ducking state, for replaying what happened offline. Off unless the host calls start(), or
+// startFromEnvironment() with AUTOCOMPRESSOR_TRACE naming a file: starting creates the drain thread, so the plug-in never does it itself.
+// Audio threads claim a cell of a preallocated ring with one atomic and copy their record in, nothing else.
+// A low-priority thread drains the ring to the file. When it falls behind, records are dropped and counted, never waited for.
+class TraceRecorder
+{
+public:
+	static TraceRecorder& get();
+
+	bool start(const char* path, AkUInt32 capacity = 1 << 16);		// capacity in records, rounded up to a power of 2. False if the file can't be opened
+	void stop();													// drains what is left and closes the file
+	void startFromEnvironment();									// start() on $AUTOCOMPRESSOR_TRACE, once per process. From the host, next to sound engine init
+	bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+	void push(const TraceRecord& record);							// audio threads, wait-free
+
+	~TraceRecorder();
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		TraceRecord record;
+	};
+
+	bool pop(TraceRecord& record);									// the drain thread only
+	void drain();
+
+	std::unique_ptr<Cell[]> cells;									// allocated by the first start() and kept, so a late push never writes into freed memory
+	size_t mask = 0;
+	alignas(kCacheLineSize) std::atomic<size_t> enqueuePos = 0;
+	alignas(kCacheLineSize) size_t dequeuePos = 0;
+	std::atomic<AkUInt32> dropped = 0;
+	std::atomic<bool> recording = false;
+	std::atomic<bool> draining = false;
+	FILE* file = nullptr;
+	std::thread drainThread;
+	std::mutex controlMutex;										// start() and stop(), never taken by audio threads
+	std::once_flag environmentChecked;
+};
@@ -0,0 +1,123 @@
+#include "TruePeak.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr double kKaiserBeta = 5.0;						// about 50 dB of stopband, peaks read within 0.2 dB up to 20 kHz at 48 kHz
+
+	double besselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; ++k)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+}
+
+TruePeak::TruePeak()
+{
+	// Kaiser windowed sinc with its cutoff at the Nyquist of the input, at 4 times its rate.
+	// Upsampled frame 4n + phase only meets inputs at taps phase, phase + 4, ..., so each phase is every 4th tap of the prototype.
+	constexpr AkUInt16 numTaps = kTapsPerPhase * kOversampling;
+	const double center = (numTaps - 1) / 2.0;
+	const double cutoff = 0.5 / kOversampling;
+	double prototype[numTaps];
+	for (AkUInt16 tap = 0; tap < numTaps; ++tap)
+	{
+		const double x = 2.0 * cutoff * (tap - center);
+		const double sinc = (x == 0.0) ? 1.0 : sin(kPi * x) / (kPi * x);
+		const double window = (tap - center) / center;
+		prototype[tap] = sinc * besselI0(kKaiserBeta * sqrt(1.0 - (window * window))) / besselI0(kKaiserBeta);
+	}
+
+	// every phase passes DC at unity, a steady signal reads the same between the samples as on them
+	for (AkUInt16 phase = 0; phase < kOversampling; ++phase)
+	{
+		double sum = 0.0;
+		for (AkUInt16 tap = 0; tap < kTapsPerPhase; ++tap)
+		{
+			sum += prototype[(tap * kOversampling) + phase];
+		}
+		for (AkUInt16 tap = 0; tap < kTapsPerPhase; ++tap)
+		{
+			coefficients[tap][phase] = static_cast<AkReal32>(prototype[(tap * kOversampling) + phase] / sum);
+		}
+	}
+	setup(48000);
+}
+
+void TruePeak::setup(AkUInt32 sampleRate)
+{
+	holdFrames = static_cast<AkUInt32>(kHoldSeconds * sampleRate);
+	release = expf(-1.0f / (kReleaseSeconds * sampleRate));
+}
+
+void TruePeak::reset()
+{
+	std::fill(&history[0][0], &history[0][0] + (2 * 2 * kTapsPerPhase), 0.0f);
+	position = 0;
+	held[0] = held[1] = 0.0f;
+	holdLeft[0] = holdLeft[1] = 0;
+}
+
+void TruePeak::process(const AkReal32* const in[2], AkUInt16 numChannels, AkUInt32 numFrames)
+{
+	AKSIMD_V4F32 taps[kTapsPerPhase];
+	for (AkUInt16 tap = 0; tap < kTapsPerPhase; ++tap)
+	{
+		taps[tap] = AKSIMD_LOAD_V4F32(coefficients[tap]);
+	}
+	const AKSIMD_V4F32 zero = AKSIMD_SETZERO_V4F32();
+
+	const AkUInt16 startPosition = position;
+	for (AkUInt16 channel = 0; channel < AkMin(numChannels, 2); ++channel)
+	{
+		AkReal32* AK_RESTRICT past = history[channel];
+		const AkReal32* AK_RESTRICT samples = in[channel];
+		AkReal32 peak = held[channel];
+		AkUInt32 hold = holdLeft[channel];
+		AkReal32 lanes[4];
+		position = startPosition;
+
+		for (AkUInt32 frame = 0; frame < numFrames; ++frame)
+		{
+			position = (position == 0) ? kTapsPerPhase - 1 : position - 1;
+			past[position] = past[position + kTapsPerPhase] = samples[frame];
+
+			// (phase 0, 1, 2, 3) of this input, then the largest magnitude of the 4
+			AKSIMD_V4F32 phases = zero;
+			for (AkUInt16 tap = 0; tap < kTapsPerPhase; ++tap)
+			{
+				phases = AKSIMD_MADD_V4F32(AKSIMD_LOAD1_V4F32(past[position + tap]), taps[tap], phases);
+			}
+			AKSIMD_V4F32 magnitude = AKSIMD_MAX_V4F32(phases, AKSIMD_SUB_V4F32(zero, phases));
+			magnitude = AKSIMD_MAX_V4F32(magnitude, AKSIMD_SHUFFLE_V4F32(magnitude, magnitude, AKSIMD_SHUFFLE(2, 3, 0, 1)));
+			magnitude = AKSIMD_MAX_V4F32(magnitude, AKSIMD_SHUFFLE_V4F32(magnitude, magnitude, AKSIMD_SHUFFLE(1, 0, 3, 2)));
+			AKSIMD_STORE_V4F32(lanes, magnitude);
+
+			if (lanes[0] >= peak)
+			{
+				peak = lanes[0];
+				hold = holdFrames;
+			}
+			else if (hold > 0)
+			{
+				hold--;
+			}
+			else
+			{
+				peak = AkMax(lanes[0], peak * release);
+			}
+		}
+
+		held[channel] = peak;
+		holdLeft[channel] = hold;
+	}
+}
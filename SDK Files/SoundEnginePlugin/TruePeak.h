@@ -0,0 +1,33 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/AkSimd.h>
+
+// True-peak level of up to two channels, the peaks between the samples as well as on them (see ITU-R BS.1770).
+// A 4x polyphase FIR interpolates every input sample into 4: the 4 phases of the filter run side by side in the 4 SIMD lanes,
+// so one input sample costs kTapsPerPhase multiply-adds for all of its interpolated values. The loudest of the 4 feeds a
+// peak hold that keeps the peak for kHoldSeconds, then lets it fall to 1/e over kReleaseSeconds.
+class TruePeak
+{
+public:
+	static constexpr AkUInt16 kOversampling = 4;
+	static constexpr AkUInt16 kTapsPerPhase = 12;			// 48 taps in all, like the BS.1770 interpolator
+	static constexpr AkReal32 kHoldSeconds = 0.01f;			// as long as the RMS window, so a crest factor can't miss its peak
+	static constexpr AkReal32 kReleaseSeconds = 0.05f;
+
+	TruePeak();
+
+	void setup(AkUInt32 sampleRate);						// keeps the held peaks and filter memory
+	void reset();											// clears them
+	void process(const AkReal32* const in[2], AkUInt16 numChannels, AkUInt32 numFrames);	// can be called a segment at a time
+	AkReal32 getPeak(AkUInt16 channel) const { return held[channel]; }	// linear, where the hold stands after the last frame processed
+
+private:
+	AkReal32 coefficients[kTapsPerPhase][kOversampling];	// [tap][phase], every phase sums to 1
+	AkReal32 history[2][2 * kTapsPerPhase] = {};			// the last inputs, written twice so the taps never wrap
+	AkUInt16 position = 0;									// newest input in history, the older ones follow it
+	AkReal32 held[2] = { 0.0f, 0.0f };
+	AkUInt32 holdLeft[2] = { 0, 0 };						// frames before the held peak starts falling
+	AkUInt32 holdFrames = 480;
+	AkReal32 release = 0.0f;								// per frame once the hold ran out
+};
@@ -0,0 +1,530 @@
+// Accuracy harness: runs signal corpora through the plug-in and through a double-precision reference of it
+// (ReferenceCompressor.cpp), and reports how far the plug-in's gain drifts from the reference, in dB.
+// Use it to prove that an optimization (approximated log10f/powf/sqrtf, control-rate processing, ...) didn't
+// change the sound. Exits with 1 when a corpus goes over the error budget, so it can run in CI.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O2 -DAK_OPTIMIZED -I"$WWISESDK/include" AutoCompressorAccuracy.cpp ReferenceCompressor.cpp
+//       ../Common/StandInHost.cpp $(ls ../../SoundEnginePlugin/*.cpp | grep -v AutoCompressorFXShared)
+//       -lpthread -o AutoCompressorAccuracy
+//
+// Usage:
+//   AutoCompressorAccuracy [--budget-db dB] [--budget-ms ms] [--budget-rms-db dB] [--strict] [--corpus name]...
+//
+// Full band corpora compare the gain of every sample (output over input). Multiband corpora can't separate the
+// gain of each band from the summed output, so they compare the energy of every 480 frame block instead.
+//
+// The gain steps where the envelope turns from release to attack, and rounding can move that turn a few frames
+// away from the reference's. Compared frame by frame, the frames in between would show the whole step (over a dB)
+// although both apply the same gain change, so the max error takes the closest reference gain (or block) within
+// --budget-ms of each frame. The default, 1 ms, is under the 2-3 ms gaps hearing can resolve, so what is left is a
+// level error and the max is held to --budget-db like the 99th percentile. The 99th percentile and the rms compare
+// the same frame. --strict sets --budget-ms to 0.
+//
+// Not covered: the corpora leave every detector option at its default, so true peak, hold, the auto threshold,
+// culling and the CPU budget's quality tiers never switch on, and the reference doesn't model them. Instances go
+// through Execute, never ExecuteBatch's lanes, and the instances of a corpus share one sample rate and buffer size.
+// A pass says nothing about the accuracy of any of those.
+
+#include "ReferenceCompressor.h"
+#include "../Common/StandInHost.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const double kDefaultBudgetDB = 0.1;        // for the 99th percentile and the max
+    const double kDefaultBudgetMS = 1.0;        // how far from a frame the max looks for the closest reference gain
+    const double kDefaultBudgetRmsDB = 0.25;
+    const double kPercentile = 0.99;
+    const double kFloorDB = -120.0;             // gains and levels are floored here, so silence compares as equal
+    const double kSignalFloor = 1e-5;           // samples quieter than -100 dBFS don't say much about the gain
+    const AkUInt16 kBlockFrames = 480;
+
+    typedef std::vector<AkReal32> Channel;
+
+    struct CorpusInstance
+    {
+        ReferenceParams params;
+        std::vector<Channel> channels;
+    };
+
+    struct Corpus
+    {
+        const char* name;
+        const char* description;
+        AkUInt32 sampleRate;
+        AkUInt16 frames;                        // buffer size
+        std::vector<CorpusInstance> instances;
+    };
+
+    // What one channel of an instance played, through the plug-in and through the reference
+    struct Recording
+    {
+        Channel output;
+        std::vector<double> reference;
+    };
+
+    struct Result
+    {
+        std::vector<float> errorsDB;            // absolute, one per measured sample or block, against the same frame
+        double maxDB = 0.0;                     // against the closest reference frame within --budget-ms
+
+        double MaxDB() const
+        {
+            return maxDB;
+        }
+
+        double PercentileDB(double in_percentile)
+        {
+            if (errorsDB.empty())
+            {
+                return 0.0;
+            }
+            auto nth = errorsDB.begin() + static_cast<ptrdiff_t>(in_percentile * (errorsDB.size() - 1));
+            std::nth_element(errorsDB.begin(), nth, errorsDB.end());
+            return *nth;
+        }
+
+        double RmsDB() const
+        {
+            double sumSquares = 0.0;
+            for (float error : errorsDB)
+            {
+                sumSquares += static_cast<double>(error) * error;
+            }
+            return sqrt(sumSquares / std::max<size_t>(errorsDB.size(), 1));
+        }
+    };
+
+    // Signal generators, all deterministic
+
+    Channel Sine(AkUInt32 in_uSampleRate, double in_seconds, double in_frequency, double in_amplitude)
+    {
+        Channel channel(static_cast<size_t>(in_seconds * in_uSampleRate));
+        for (size_t frame = 0; frame < channel.size(); ++frame)
+        {
+            channel[frame] = static_cast<AkReal32>(in_amplitude * sin(2.0 * 3.14159265358979323846 * in_frequency * frame / in_uSampleRate));
+        }
+        return channel;
+    }
+
+    Channel Noise(AkUInt32 in_uSampleRate, double in_seconds, double in_amplitude, unsigned in_seed)
+    {
+        std::mt19937 rng(in_seed);
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+        Channel channel(static_cast<size_t>(in_seconds * in_uSampleRate));
+        for (AkReal32& sample : channel)
+        {
+            sample = static_cast<AkReal32>(in_amplitude * uniform(rng));
+        }
+        return channel;
+    }
+
+    // Multiplies by an envelope given in seconds
+    Channel Shape(Channel in_channel, AkUInt32 in_uSampleRate, const std::function<double(double)>& in_envelope)
+    {
+        for (size_t frame = 0; frame < in_channel.size(); ++frame)
+        {
+            in_channel[frame] = static_cast<AkReal32>(in_channel[frame] * in_envelope(static_cast<double>(frame) / in_uSampleRate));
+        }
+        return in_channel;
+    }
+
+    Channel Mix(const Channel& in_a, const Channel& in_b)
+    {
+        Channel channel(std::max(in_a.size(), in_b.size()), 0.0f);
+        for (size_t frame = 0; frame < channel.size(); ++frame)
+        {
+            channel[frame] = (frame < in_a.size() ? in_a[frame] : 0.0f) + (frame < in_b.size() ? in_b[frame] : 0.0f);
+        }
+        return channel;
+    }
+
+    // Noise shaped by syllables (~4 per second) grouped in phrases with pauses in between
+    Channel SpeechLike(AkUInt32 in_uSampleRate, double in_seconds, double in_amplitude, unsigned in_seed)
+    {
+        std::mt19937 rng(in_seed);
+        std::vector<double> phraseStarts;
+        for (double time = 0.5; time < in_seconds; time += 1.5 + 2.0 * std::uniform_real_distribution<double>(0.0, 1.0)(rng))
+        {
+            phraseStarts.push_back(time);
+        }
+        return Shape(Noise(in_uSampleRate, in_seconds, in_amplitude, in_seed + 1), in_uSampleRate, [phraseStarts](double in_time)
+        {
+            for (double start : phraseStarts)
+            {
+                if (in_time >= start && in_time < start + 1.2)
+                {
+                    const double syllable = sin(3.14159265358979323846 * 4.0 * (in_time - start));
+                    return syllable * syllable;
+                }
+            }
+            return 0.0;
+        });
+    }
+
+    std::function<double(double)> Gate(double in_on, double in_off, double in_delay = 0.0)
+    {
+        return [=](double in_time)
+        {
+            return (in_time >= in_delay && std::fmod(in_time - in_delay, in_on + in_off) < in_on) ? 1.0 : 0.0;
+        };
+    }
+
+    ReferenceParams Ducker(double in_threshold, double in_ratio, double in_priority)
+    {
+        ReferenceParams params;
+        params.threshold = in_threshold;
+        params.ratio = in_ratio;
+        params.priority = in_priority;
+        params.knee = 6.0;
+        params.attack = 0.01;
+        params.release = 0.2;
+        return params;
+    }
+
+    ReferenceParams Multiband(AkUInt16 in_uBands, double in_threshold, double in_ratio, double in_priority)
+    {
+        ReferenceParams params = Ducker(in_threshold, in_ratio, in_priority);
+        params.bands = in_uBands;
+        for (AkUInt16 band = 0; band < in_uBands; ++band)
+        {
+            params.bandThreshold[band] = in_threshold - (3.0 * band);
+            params.bandRatio[band] = in_ratio;
+        }
+        return params;
+    }
+
+    std::vector<Corpus> MakeCorpora()
+    {
+        std::vector<Corpus> corpora;
+        const AkUInt32 sr = 48000;
+        const double seconds = 12.0;
+
+        corpora.push_back({ "sines", "steady 220 Hz ducked by a gated 1 kHz", sr, 512, {
+            { Ducker(-30.0, 4.0, 1.0), { Sine(sr, seconds, 220.0, 0.5), Sine(sr, seconds, 220.0, 0.5) } },
+            { Ducker(-30.0, 4.0, 10.0), { Shape(Sine(sr, seconds, 1000.0, 0.25), sr, Gate(2.0, 2.0, 1.0)),
+                                          Shape(Sine(sr, seconds, 1000.0, 0.25), sr, Gate(2.0, 2.0, 1.0)) } } } });
+
+        corpora.push_back({ "noise-bursts", "steady noise, short and long bursts, three priorities", sr, 512, {
+            { Ducker(-40.0, 6.0, 1.0), { Noise(sr, seconds, 0.1, 1), Noise(sr, seconds, 0.1, 2) } },
+            { Ducker(-30.0, 3.0, 5.0), { Shape(Noise(sr, seconds, 0.5, 3), sr, Gate(0.1, 0.6)),
+                                         Shape(Noise(sr, seconds, 0.5, 4), sr, Gate(0.1, 0.6)) } },
+            { Ducker(-30.0, 8.0, 10.0), { Shape(Noise(sr, seconds, 0.7, 5), sr, Gate(1.5, 2.5, 0.3)),
+                                          Shape(Noise(sr, seconds, 0.7, 6), sr, Gate(1.5, 2.5, 0.3)) } } } });
+
+        corpora.push_back({ "speech-like", "music bed ducked by dialogue phrases", sr, 512, {
+            { Ducker(-35.0, 4.0, 1.0), { Mix(Sine(sr, seconds, 110.0, 0.3), Sine(sr, seconds, 330.0, 0.15)),
+                                         Mix(Sine(sr, seconds, 165.0, 0.3), Sine(sr, seconds, 440.0, 0.15)) } },
+            { Ducker(-35.0, 4.0, 10.0), { SpeechLike(sr, seconds, 0.6, 7), SpeechLike(sr, seconds, 0.6, 7) } } } });
+
+        corpora.push_back({ "silence", "silent instances, one coming in late", sr, 512, {
+            { Ducker(-30.0, 4.0, 1.0), { Channel(static_cast<size_t>(seconds * sr), 0.0f), Channel(static_cast<size_t>(seconds * sr), 0.0f) } },
+            { Ducker(-30.0, 4.0, 5.0), { Shape(Noise(sr, seconds, 0.5, 8), sr, Gate(seconds, 0.0, 6.0)),
+                                         Shape(Noise(sr, seconds, 0.5, 9), sr, Gate(seconds, 0.0, 6.0)) } },
+            { Ducker(-30.0, 4.0, 10.0), { Channel(static_cast<size_t>(seconds * sr), 0.0f), Channel(static_cast<size_t>(seconds * sr), 0.0f) } } } });
+
+        corpora.push_back({ "mono-44k-441", "mono at 44.1 kHz, 441 frame buffers, partial last buffer", 44100, 441, {
+            { Ducker(-40.0, 4.0, 1.0), { Noise(44100, seconds + 0.003, 0.1, 10) } },
+            { Ducker(-30.0, 4.0, 10.0), { SpeechLike(44100, seconds + 0.003, 0.6, 11) } } } });
+
+        corpora.push_back({ "multiband-4", "4 bands, low music and high dialogue overlapping in band 1", sr, 512, {
+            { Multiband(4, -35.0, 4.0, 1.0), { Mix(Sine(sr, seconds, 80.0, 0.4), Shape(Noise(sr, seconds, 0.05, 12), sr, Gate(seconds, 0.0))),
+                                               Mix(Sine(sr, seconds, 500.0, 0.2), Noise(sr, seconds, 0.05, 13)) } },
+            { Multiband(4, -35.0, 4.0, 10.0), { SpeechLike(sr, seconds, 0.6, 14), SpeechLike(sr, seconds, 0.6, 15) } } } });
+
+        corpora.push_back({ "multiband-3", "3 bands against a full band instance on the same group", sr, 256, {
+            { Multiband(3, -35.0, 6.0, 1.0), { Mix(Sine(sr, seconds, 200.0, 0.4), Sine(sr, seconds, 3000.0, 0.2)),
+                                               Mix(Sine(sr, seconds, 200.0, 0.4), Sine(sr, seconds, 3000.0, 0.2)) } },
+            { Ducker(-35.0, 4.0, 10.0), { Shape(Noise(sr, seconds, 0.4, 16), sr, Gate(1.0, 1.0)),
+                                          Shape(Noise(sr, seconds, 0.4, 17), sr, Gate(1.0, 1.0)) } } } });
+
+        return corpora;
+    }
+
+    double ToDB(double in_value)
+    {
+        return std::max(kFloorDB, 20.0 * log10(in_value));
+    }
+
+    void Measure(Result& io_result, double in_errorDB, double in_closestErrorDB)
+    {
+        // NaN stays NaN, and fails every budget
+        io_result.errorsDB.push_back(static_cast<float>(std::fabs(in_errorDB)));
+        if (!std::isnan(io_result.maxDB) && !(in_closestErrorDB <= io_result.maxDB))
+        {
+            io_result.maxDB = in_closestErrorDB;
+        }
+    }
+
+    template<typename T>
+    double Energy(const std::vector<T>& in_samples, size_t in_start, size_t in_uFrames)
+    {
+        double energy = 0.0;
+        for (size_t frame = in_start; frame < in_start + in_uFrames; ++frame)
+        {
+            energy += static_cast<double>(in_samples[frame]) * in_samples[frame];
+        }
+        return energy;
+    }
+
+    // The error of a gain against the closest reference gain within in_uTolerance frames of it. Frames the reference
+    // isn't measured on are NaN and never the closest, a NaN error on the same frame stays NaN.
+    double ClosestErrorDB(double in_gainDB, const std::vector<double>& in_referenceDB, size_t in_frame, size_t in_uTolerance)
+    {
+        double closest = std::fabs(in_gainDB - in_referenceDB[in_frame]);
+        const size_t last = std::min(in_referenceDB.size() - 1, in_frame + in_uTolerance);
+        for (size_t frame = in_frame - std::min(in_frame, in_uTolerance); frame <= last; ++frame)
+        {
+            const double error = std::fabs(in_gainDB - in_referenceDB[frame]);
+            if (error < closest)
+            {
+                closest = error;
+            }
+        }
+        return closest;
+    }
+
+    // The same for the energy of a block, against the reference's block moved by up to in_uTolerance frames
+    double ClosestBlockErrorDB(double in_errorDB, double in_energy, const std::vector<double>& in_reference, size_t in_start, size_t in_uFrames, size_t in_uTolerance)
+    {
+        double closest = std::fabs(in_errorDB);
+        const size_t first = in_start - std::min(in_start, in_uTolerance);
+        const size_t last = std::min(in_reference.size() - in_uFrames, in_start + in_uTolerance);
+        double referenceEnergy = Energy(in_reference, first, in_uFrames);
+        for (size_t start = first; start <= last; ++start)
+        {
+            const double error = std::fabs(ToDB(in_energy) - ToDB(referenceEnergy)) / 2.0;
+            if (error < closest)
+            {
+                closest = error;
+            }
+            if (start < last)
+            {
+                referenceEnergy += (in_reference[start + in_uFrames] * in_reference[start + in_uFrames]) - (in_reference[start] * in_reference[start]);
+            }
+        }
+        return closest;
+    }
+
+    void MeasureGains(Result& io_result, const Channel& in_input, const Recording& in_recording, size_t in_uTolerance)
+    {
+        const size_t length = in_recording.output.size();
+        std::vector<double> referenceDB(length, std::numeric_limits<double>::quiet_NaN());
+        for (size_t frame = 0; frame < length; ++frame)
+        {
+            const double in = (frame < in_input.size()) ? in_input[frame] : 0.0;
+            if (std::fabs(in) > kSignalFloor)
+            {
+                referenceDB[frame] = ToDB(in_recording.reference[frame] / in);
+            }
+        }
+
+        for (size_t frame = 0; frame < length; ++frame)
+        {
+            const double in = (frame < in_input.size()) ? in_input[frame] : 0.0;
+            if (std::fabs(in) > kSignalFloor)
+            {
+                const double gainDB = ToDB(in_recording.output[frame] / in);
+                Measure(io_result, gainDB - referenceDB[frame], ClosestErrorDB(gainDB, referenceDB, frame, in_uTolerance));
+            }
+        }
+    }
+
+    // Blocks don't cross buffers, so a partial last buffer is measured on its own
+    void MeasureBlocks(Result& io_result, const Recording& in_recording, AkUInt16 in_uBufferFrames, size_t in_uTolerance)
+    {
+        const size_t length = in_recording.output.size();
+        for (size_t start = 0; start < length; start += in_uBufferFrames)
+        {
+            const size_t end = std::min<size_t>(length, start + in_uBufferFrames);
+            for (size_t block = start; block < end; block += kBlockFrames)
+            {
+                const size_t frames = std::min<size_t>(end - block, kBlockFrames);
+                const double energy = Energy(in_recording.output, block, frames);
+                const double referenceEnergy = Energy(in_recording.reference, block, frames);
+                if (std::max(energy, referenceEnergy) > kSignalFloor * kSignalFloor * kBlockFrames)
+                {
+                    const double errorDB = (ToDB(energy) - ToDB(referenceEnergy)) / 2.0;
+                    Measure(io_result, errorDB, ClosestBlockErrorDB(errorDB, energy, in_recording.reference, block, frames, in_uTolerance));
+                }
+            }
+        }
+    }
+
+    void SetParams(StandInVoice& io_voice, const ReferenceParams& in_params)
+    {
+        io_voice.SetParam(PARAM_THRESHOLD_ID, static_cast<AkReal32>(in_params.threshold));
+        io_voice.SetParam(PARAM_PRIORITY_ID, static_cast<AkReal32>(in_params.priority));
+        io_voice.SetParam(PARAM_RATIO_ID, static_cast<AkReal32>(in_params.ratio));
+        io_voice.SetParam(PARAM_KNEE_ID, static_cast<AkReal32>(in_params.knee));
+        io_voice.SetParam(PARAM_ATTACK_ID, static_cast<AkReal32>(in_params.attack));
+        io_voice.SetParam(PARAM_RELEASE_ID, static_cast<AkReal32>(in_params.release));
+        io_voice.SetParam(PARAM_BANDS_ID, static_cast<AkInt32>(in_params.bands));
+        for (AkPluginParamID crossover = 0; crossover < static_cast<AkPluginParamID>(MAX_BANDS - 1); ++crossover)
+        {
+            io_voice.SetParam(PARAM_CROSSOVER1_ID + crossover, static_cast<AkReal32>(in_params.crossover[crossover]));
+        }
+        for (AkPluginParamID band = 0; band < static_cast<AkPluginParamID>(MAX_BANDS); ++band)
+        {
+            io_voice.SetParam(PARAM_BAND1_THRESHOLD_ID + band, static_cast<AkReal32>(in_params.bandThreshold[band]));
+            io_voice.SetParam(PARAM_BAND1_RATIO_ID + band, static_cast<AkReal32>(in_params.bandRatio[band]));
+        }
+    }
+
+    // Every corpus gets its own group, so no bus state carries over from one corpus to the next
+    Result RunCorpus(const Corpus& in_corpus, AkInt32 in_iGroup, double in_budgetMS)
+    {
+        StandInAllocator allocator;
+        const size_t numInstances = in_corpus.instances.size();
+        std::vector<StandInVoice> voices(numInstances);
+        ReferenceGroup reference(in_corpus.sampleRate);
+        size_t length = 0;
+        for (size_t instance = 0; instance < numInstances; ++instance)
+        {
+            const CorpusInstance& corpusInstance = in_corpus.instances[instance];
+            const AkUInt16 uNumChannels = static_cast<AkUInt16>(corpusInstance.channels.size());
+            voices[instance].Init(allocator, in_corpus.sampleRate, uNumChannels, in_corpus.frames, in_iGroup);
+            SetParams(voices[instance], corpusInstance.params);
+            reference.AddInstance(uNumChannels, corpusInstance.params);
+            length = std::max(length, corpusInstance.channels[0].size());
+        }
+
+        std::vector<std::vector<Recording>> recordings(numInstances);
+        for (size_t instance = 0; instance < numInstances; ++instance)
+        {
+            recordings[instance].resize(voices[instance].NumChannels());
+        }
+
+        std::vector<double> referenceBuffer[2] = { std::vector<double>(in_corpus.frames), std::vector<double>(in_corpus.frames) };
+        for (size_t start = 0; start < length; start += in_corpus.frames)
+        {
+            const AkUInt16 uValidFrames = static_cast<AkUInt16>(std::min<size_t>(in_corpus.frames, length - start));
+            for (size_t instance = 0; instance < numInstances; ++instance)
+            {
+                const CorpusInstance& corpusInstance = in_corpus.instances[instance];
+                StandInVoice& voice = voices[instance];
+                double* referenceChannels[2] = { referenceBuffer[0].data(), referenceBuffer[1].data() };
+
+                for (AkUInt16 channel = 0; channel < voice.NumChannels(); ++channel)
+                {
+                    const Channel& input = corpusInstance.channels[channel];
+                    for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+                    {
+                        const AkReal32 sample = (start + frame < input.size()) ? input[start + frame] : 0.0f;
+                        voice.GetChannel(channel)[frame] = sample;
+                        referenceChannels[channel][frame] = sample;
+                    }
+                }
+
+                voice.Execute(uValidFrames);
+                reference.Execute(instance, referenceChannels, uValidFrames);
+
+                for (AkUInt16 channel = 0; channel < voice.NumChannels(); ++channel)
+                {
+                    Recording& recording = recordings[instance][channel];
+                    recording.output.insert(recording.output.end(), voice.GetChannel(channel), voice.GetChannel(channel) + uValidFrames);
+                    recording.reference.insert(recording.reference.end(), referenceChannels[channel], referenceChannels[channel] + uValidFrames);
+                }
+            }
+        }
+
+        // measured once everything has played, the closest reference frame can be a later one
+        Result result;
+        const size_t uTolerance = static_cast<size_t>(in_budgetMS * in_corpus.sampleRate / 1000.0);
+        for (size_t instance = 0; instance < numInstances; ++instance)
+        {
+            const CorpusInstance& corpusInstance = in_corpus.instances[instance];
+            for (size_t channel = 0; channel < recordings[instance].size(); ++channel)
+            {
+                if (corpusInstance.params.bands == 1)
+                {
+                    MeasureGains(result, corpusInstance.channels[channel], recordings[instance][channel], uTolerance);
+                }
+                else
+                {
+                    MeasureBlocks(result, recordings[instance][channel], in_corpus.frames, uTolerance);
+                }
+            }
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double budgetDB = kDefaultBudgetDB;
+    double budgetMS = kDefaultBudgetMS;
+    double budgetRmsDB = kDefaultBudgetRmsDB;
+    bool strict = false;
+    std::vector<std::string> selected;
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        const std::string option = argv[arg];
+        if (option == "--budget-db" && arg + 1 < argc)
+        {
+            budgetDB = strtod(argv[++arg], nullptr);
+        }
+        else if (option == "--budget-ms" && arg + 1 < argc)
+        {
+            budgetMS = strtod(argv[++arg], nullptr);
+        }
+        else if (option == "--budget-rms-db" && arg + 1 < argc)
+        {
+            budgetRmsDB = strtod(argv[++arg], nullptr);
+        }
+        else if (option == "--strict")
+        {
+            strict = true;
+        }
+        else if (option == "--corpus" && arg + 1 < argc)
+        {
+            selected.push_back(argv[++arg]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: AutoCompressorAccuracy [--budget-db dB] [--budget-ms ms] [--budget-rms-db dB] [--strict] [--corpus name]...\n");
+            return 2;
+        }
+    }
+
+    if (strict)
+    {
+        budgetMS = 0.0;
+    }
+
+    const std::vector<Corpus> corpora = MakeCorpora();
+    printf("%-16s %-58s %10s %10s %10s\n", "corpus", "", "max dB", "p99 dB", "rms dB");
+
+    bool passed = true;
+    AkInt32 iGroup = 0;
+    for (const Corpus& corpus : corpora)
+    {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), corpus.name) == selected.end())
+        {
+            continue;
+        }
+
+        Result result = RunCorpus(corpus, iGroup++, budgetMS);
+        const double maxDB = result.MaxDB();
+        const double percentileDB = result.PercentileDB(kPercentile);
+        const double rmsDB = result.RmsDB();
+
+        // written so that NaN fails
+        const bool withinBudget = (percentileDB <= budgetDB) && (maxDB <= budgetDB) && (rmsDB <= budgetRmsDB);
+        passed = passed && withinBudget;
+        printf("%-16s %-58s %10.5f %10.5f %10.5f  %s\n", corpus.name, corpus.description, maxDB, percentileDB, rmsDB, withinBudget ? "ok" : "OVER BUDGET");
+    }
+
+    printf("\nbudget %.4f dB (p99, and max within %.2f ms), rms %.4f dB: %s\n", budgetDB, budgetMS, budgetRmsDB, passed ? "pass" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,493 @@
+#include "ReferenceCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const double kPi = 3.14159265358979323846;
+    const double kEpsilon = 1e-6;
+
+    enum EnvState
+    {
+        env_idle = 0,
+        env_attack,
+        env_sustain,
+        env_release
+    };
+
+    enum FilterType
+    {
+        filter_lowpass = 0,
+        filter_highpass,
+        filter_allpass
+    };
+
+    double LinToDB(double in_lin)
+    {
+        return 20.0 * log10(in_lin);
+    }
+
+    double DBToLin(double in_dB)
+    {
+        return pow(10.0, in_dB / 20.0);
+    }
+}
+
+void ReferenceCrossover::Setup(AkUInt16 in_uBands, const double in_frequencies[kMaxBands - 1], AkUInt32 in_uSampleRate)
+{
+    m_uBands = std::clamp<AkUInt16>(in_uBands, 1, kMaxBands);
+
+    double freq[kMaxBands - 1];
+    double lowest = 20.0;
+    for (AkUInt16 i = 0; i < kMaxBands - 1; ++i)
+    {
+        freq[i] = std::clamp(in_frequencies[i], lowest, 0.45 * in_uSampleRate);
+        lowest = freq[i];
+    }
+
+    auto design = [in_uSampleRate](FilterType in_type, double in_frequency)
+    {
+        const double w0 = 2.0 * kPi * in_frequency / in_uSampleRate;
+        const double alpha = sin(w0) / (2.0 * sqrt(0.5));
+        const double a0 = 1.0 + alpha;
+        Biquad biquad = {};
+        switch (in_type)
+        {
+        case filter_lowpass:
+            biquad.b0 = biquad.b2 = (1.0 - cos(w0)) / 2.0 / a0;
+            biquad.b1 = (1.0 - cos(w0)) / a0;
+            break;
+        case filter_highpass:
+            biquad.b0 = biquad.b2 = (1.0 + cos(w0)) / 2.0 / a0;
+            biquad.b1 = -(1.0 + cos(w0)) / a0;
+            break;
+        case filter_allpass:
+            biquad.b0 = (1.0 - alpha) / a0;
+            biquad.b1 = -2.0 * cos(w0) / a0;
+            biquad.b2 = 1.0;
+            break;
+        }
+        biquad.a1 = -2.0 * cos(w0) / a0;
+        biquad.a2 = (1.0 - alpha) / a0;
+        return biquad;
+    };
+
+    // Band b is the high-pass of every crossover below it, the low-pass of the one above it,
+    // and the allpass of the remaining crossovers above, exactly like the SIMD lanes of Crossover
+    for (AkUInt16 band = 0; band < kMaxBands; ++band)
+    {
+        m_chains[band].clear();
+        if (band >= m_uBands)
+        {
+            continue;
+        }
+        for (AkUInt16 split = 0; split < m_uBands - 1; ++split)
+        {
+            if (split < band)
+            {
+                m_chains[band].push_back(design(filter_highpass, freq[split]));
+                m_chains[band].push_back(design(filter_highpass, freq[split]));
+            }
+            else if (split == band)
+            {
+                m_chains[band].push_back(design(filter_lowpass, freq[split]));
+                m_chains[band].push_back(design(filter_lowpass, freq[split]));
+            }
+            else
+            {
+                m_chains[band].push_back(design(filter_allpass, freq[split]));
+            }
+        }
+    }
+}
+
+void ReferenceCrossover::Process(const double* const in_ppChannels[2], AkUInt16 in_uNumChannels, AkUInt32 in_uFrames, double* const out_ppBands[kMaxBands][2])
+{
+    for (AkUInt16 band = 0; band < m_uBands; ++band)
+    {
+        for (AkUInt16 channel = 0; channel < in_uNumChannels; ++channel)
+        {
+            for (AkUInt32 frame = 0; frame < in_uFrames; ++frame)
+            {
+                double x = in_ppChannels[channel][frame];
+                for (Biquad& biquad : m_chains[band])
+                {
+                    const double y = (biquad.b0 * x) + biquad.z1[channel];
+                    biquad.z1[channel] = (biquad.b1 * x) + biquad.z2[channel] - (biquad.a1 * y);
+                    biquad.z2[channel] = (biquad.b2 * x) - (biquad.a2 * y);
+                    x = y;
+                }
+                out_ppBands[band][channel][frame] = x;
+            }
+        }
+    }
+}
+
+ReferenceGroup::ReferenceGroup(AkUInt32 in_uSampleRate)
+    : m_uSampleRate(in_uSampleRate)
+{
+}
+
+size_t ReferenceGroup::AddInstance(AkUInt16 in_uNumChannels, const ReferenceParams& in_params)
+{
+    m_instances.emplace_back();
+    Instance& instance = m_instances.back();
+    instance.params = in_params;
+    instance.params.bands = std::clamp<AkUInt16>(in_params.bands, 1, kMaxBands);
+    instance.numChannels = in_uNumChannels;
+    instance.crossover.Setup(instance.params.bands, instance.params.crossover, m_uSampleRate);
+    return m_instances.size() - 1;
+}
+
+double ReferenceGroup::RatioPercentile(double in_priority) const
+{
+    double value = 1.0;
+    if (m_minPriority == m_maxPriority)
+    {
+        // the plug-in computes 1 / numInstances in integers: 1 for a lone instance, 0 otherwise
+        value = (m_instances.size() == 1) ? 0.0 : 1.0;
+    }
+    else
+    {
+        value = 1.0 - ((in_priority - m_minPriority) / (m_maxPriority - m_minPriority));
+    }
+    return std::clamp(value, 0.0, 1.0);
+}
+
+void ReferenceGroup::Execute(size_t in_instance, double* const* io_ppChannels, AkUInt16 in_uValidFrames)
+{
+    Instance& instance = m_instances[in_instance];
+    const ReferenceParams& params = instance.params;
+    const AkUInt16 uNumChannels = instance.numChannels;
+    const AkUInt32 frames10ms = m_uSampleRate / 100;
+    const double msWeight = 1.0 / (frames10ms * uNumChannels);
+    double startMS[kNumKeys][2];
+    std::copy(&instance.myMS[0][0], &instance.myMS[0][0] + (kNumKeys * 2), &startMS[0][0]);
+
+    // the bus side of the tick
+    m_priorityList.push_back(params.priority);
+    if (m_sharedBuffer.empty())
+    {
+        m_sharedBuffer.assign(uNumChannels, std::vector<double>(in_uValidFrames, 0.0));
+    }
+    for (AkUInt16 channel = 0; channel < m_sharedBuffer.size() && channel < uNumChannels; ++channel)
+    {
+        for (AkUInt16 frame = 0; frame < std::min<size_t>(in_uValidFrames, m_sharedBuffer[channel].size()); ++frame)
+        {
+            m_sharedBuffer[channel][frame] += io_ppChannels[channel][frame];
+        }
+    }
+    if (params.bands > 1)
+    {
+        m_bandsRequested = true;
+        if (m_busBands != params.bands)
+        {
+            m_busBands = params.bands;
+            m_busCrossover.Setup(params.bands, params.crossover, m_uSampleRate);
+        }
+    }
+    std::copy(&instance.lastbuffer_looRMS[0][0], &instance.lastbuffer_looRMS[0][0] + (kNumKeys * 2), &instance.lastKeyRMS[0][0]);
+    std::copy(&instance.newbuffer_looRMS[0][0], &instance.newbuffer_looRMS[0][0] + (kNumKeys * 2), &instance.newKeyRMS[0][0]);
+    BuildSidechain(instance, msWeight);
+    for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+    {
+        std::copy(&startMS[0][0], &startMS[0][0] + (kNumKeys * 2), &instance.envelope[point][0][0]);
+    }
+
+    const double percentile = RatioPercentile(params.priority);
+    const double attack = std::max(kEpsilon, params.attack);
+    const double release = std::max(kEpsilon, params.release);
+    const double overshootA = 0.3;
+    const double overshootR = 0.01;
+    GainSettings settings[kMaxBands];
+    for (AkUInt16 band = 0; band < params.bands; ++band)
+    {
+        const bool multiband = params.bands > 1;
+        const double bandRatio = multiband ? params.bandRatio[band] : params.ratio;
+        settings[band].key = multiband ? static_cast<AkUInt16>(1 + band) : 0;
+        settings[band].thresholdDB = multiband ? params.bandThreshold[band] : params.threshold;
+        settings[band].kneeDB = params.knee;
+        settings[band].realRatio = (percentile * (bandRatio - 1.0)) + 1.0;
+        settings[band].attackRate = exp(-log((1.0 + overshootA) / overshootA) / (attack * m_uSampleRate));
+        settings[band].releaseRate = exp(-log((1.0 + overshootR) / overshootR) / (release * m_uSampleRate));
+        settings[band].overshootA = overshootA;
+        settings[band].overshootR = overshootR;
+        settings[band].msWeight = msWeight;
+    }
+
+    for (AkUInt16 channel = 0; channel < uNumChannels; ++channel)
+    {
+        double* pBuf = io_ppChannels[channel];
+        if (params.bands == 1)
+        {
+            ProcessGain(instance, settings[0], 0, channel, pBuf, 0, in_uValidFrames, in_uValidFrames);
+        }
+        else
+        {
+            double& fullBandMS = instance.myMS[0][channel];
+            AkUInt16 frame = 0;
+            for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+            {
+                for (; frame < EnvelopeFrame(point + 1, in_uValidFrames); ++frame)
+                {
+                    fullBandMS += (pBuf[frame] * pBuf[frame] - fullBandMS) * msWeight;
+                }
+                instance.envelope[point][0][channel] = fullBandMS;
+            }
+        }
+    }
+    if (params.bands > 1)
+    {
+        ProcessBands(instance, io_ppChannels, in_uValidFrames, settings);
+    }
+
+    for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+    {
+        const double pointDecay = pow(1.0 - msWeight, EnvelopeFrame(point + 1, in_uValidFrames));
+        for (AkUInt16 channel = 0; channel < std::min<AkUInt16>(uNumChannels, 2); ++channel)
+        {
+            instance.decay[channel] = pointDecay;
+            for (AkUInt16 key = 0; key < kNumKeys; ++key)
+            {
+                instance.envelope[point][key][channel] -= startMS[key][channel] * pointDecay;
+            }
+        }
+    }
+    instance.envelopeFrames = in_uValidFrames;
+
+    if (++m_executed >= m_instances.size())
+    {
+        CloseTick(frames10ms);
+        m_executed = 0;
+    }
+}
+
+void ReferenceGroup::ProcessGain(Instance& io_instance, const GainSettings& in_settings, AkUInt16 in_uBand, AkUInt16 in_uChannel, double* io_pBuf, AkUInt16 in_uFirstFrame, AkUInt16 in_uFrames, AkUInt16 in_uMaxFrames)
+{
+    const double* sidechain = io_instance.sidechainRMS[in_settings.key][in_uChannel];
+    double& keyMS = io_instance.myMS[in_settings.key][in_uChannel];
+    AkUInt16& state = io_instance.env_state[in_uBand];
+    double& target = io_instance.env_target[in_uBand][in_uChannel];
+    double& ratio = io_instance.env_ratio[in_uBand][in_uChannel];
+    double& output = io_instance.env_output[in_uBand][in_uChannel];
+    double& outputPeak = io_instance.env_outputPeak[in_uBand][in_uChannel];
+    const AkUInt16 i = in_uChannel;
+
+    for (AkUInt16 offset = 0; offset < in_uFrames; ++offset)
+    {
+        const AkUInt16 frame = in_uFirstFrame + offset;
+
+        // the last tick's sidechain at the same point of the buffer, between its envelope points
+        const double position = (frame + 1) * static_cast<double>(kEnvelopePoints) / in_uMaxFrames;
+        const AkUInt16 segment = std::min<AkUInt16>(static_cast<AkUInt16>(position), kEnvelopePoints - 1);
+        const double movingSBRMS = sidechain[segment] + ((position - segment) * (sidechain[segment + 1] - sidechain[segment]));
+
+        const double x = LinToDB(movingSBRMS);
+        keyMS += (io_pBuf[offset] * io_pBuf[offset] - keyMS) * in_settings.msWeight;
+        for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+        {
+            if (EnvelopeFrame(point + 1, in_uMaxFrames) == frame + 1)
+            {
+                io_instance.envelope[point][in_settings.key][i] = keyMS;
+            }
+        }
+
+        // static curve
+        const double thresholdDB = in_settings.thresholdDB;
+        const double kneeDB = in_settings.kneeDB;
+        double y = x;
+        if (x > thresholdDB + (kneeDB / 2.0))
+        {
+            y = ((x - thresholdDB) / in_settings.realRatio) + thresholdDB;
+        }
+        else if (x > thresholdDB - (kneeDB / 2.0))
+        {
+            const double m = ((1.0 / in_settings.realRatio) - 1.0) / (2.0 * kneeDB);
+            y = x + (m * pow(x - (thresholdDB - (kneeDB / 2.0)), 2.0));
+        }
+
+        // envelope
+        target = -(y - x);
+        if (target > output)
+        {
+            state = env_attack;
+        }
+        else if (state != env_idle)
+        {
+            state = env_release;
+        }
+
+        switch (state)
+        {
+        case env_attack:
+            ratio = (ratio * in_settings.attackRate) + ((1.0 + in_settings.overshootA) * (1.0 - in_settings.attackRate));
+            output = ratio * target;
+            outputPeak = output;
+            if (ratio >= 1.0)
+            {
+                ratio = 1.0;
+                state = env_sustain;
+            }
+            break;
+        case env_release:
+            ratio = (ratio * in_settings.releaseRate) + (-in_settings.overshootR * (1.0 - in_settings.releaseRate));
+            output = ratio * outputPeak;
+            if (ratio < 0.0)
+            {
+                ratio = 0.0;
+                state = env_idle;
+            }
+            break;
+        default:
+            break;
+        }
+
+        io_pBuf[offset] *= std::clamp(DBToLin(-output), 0.0, 1.0);
+    }
+}
+
+void ReferenceGroup::ProcessBands(Instance& io_instance, double* const* io_ppChannels, AkUInt16 in_uValidFrames, const GainSettings in_settings[kMaxBands])
+{
+    const AkUInt16 uNumChannels = std::min<AkUInt16>(io_instance.numChannels, 2);
+    const AkUInt16 uBands = io_instance.params.bands;
+    double* bands[kMaxBands][2];
+    for (AkUInt16 band = 0; band < kMaxBands; ++band)
+    {
+        for (AkUInt16 channel = 0; channel < 2; ++channel)
+        {
+            io_instance.bandScratch[band][channel].resize(kChunkFrames);
+            bands[band][channel] = io_instance.bandScratch[band][channel].data();
+        }
+    }
+
+    for (AkUInt16 chunkStart = 0; chunkStart < in_uValidFrames; chunkStart += kChunkFrames)
+    {
+        const AkUInt16 chunkFrames = std::min<AkUInt16>(kChunkFrames, in_uValidFrames - chunkStart);
+        const double* in[2] = { io_ppChannels[0] + chunkStart, io_ppChannels[uNumChannels - 1] + chunkStart };
+        io_instance.crossover.Process(in, uNumChannels, chunkFrames, bands);
+
+        for (AkUInt16 channel = 0; channel < uNumChannels; ++channel)
+        {
+            for (AkUInt16 band = 0; band < uBands; ++band)
+            {
+                ProcessGain(io_instance, in_settings[band], band, channel, bands[band][channel], chunkStart, chunkFrames, in_uValidFrames);
+            }
+            for (AkUInt16 frame = 0; frame < chunkFrames; ++frame)
+            {
+                double sum = 0.0;
+                for (AkUInt16 band = 0; band < uBands; ++band)
+                {
+                    sum += bands[band][channel][frame];
+                }
+                io_ppChannels[channel][chunkStart + frame] = sum;
+            }
+        }
+    }
+}
+
+void ReferenceGroup::BuildSidechain(Instance& io_instance, double in_msWeight)
+{
+    for (AkUInt16 key = 0; key < kNumKeys; ++key)
+    {
+        for (AkUInt16 channel = 0; channel < 2; ++channel)
+        {
+            double* points = io_instance.sidechainRMS[key][channel];
+            const double lastRMS = io_instance.lastKeyRMS[key][channel];
+            const double newRMS = io_instance.newKeyRMS[key][channel];
+            points[0] = lastRMS;
+            points[kEnvelopePoints] = newRMS;
+            for (AkUInt16 point = 1; point < kEnvelopePoints; ++point)
+            {
+                if (io_instance.envelopeFrames == 0)
+                {
+                    points[point] = lastRMS + ((newRMS - lastRMS) * point / kEnvelopePoints);
+                    continue;
+                }
+                const double decay = pow(1.0 - in_msWeight, EnvelopeFrame(point, io_instance.envelopeFrames));
+                const double others = std::max(m_envelopeMS[point - 1][key][channel] - io_instance.envelope[point - 1][key][channel], 0.0);
+                points[point] = sqrt((lastRMS * lastRMS * decay) + others);
+            }
+        }
+    }
+}
+
+void ReferenceGroup::CloseTick(AkUInt32 in_uFrames10ms)
+{
+    double envelope[kEnvelopePoints][kNumKeys][2] = {};
+    for (const Instance& instance : m_instances)
+    {
+        for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+        {
+            envelope[point][0][0] += instance.envelope[point][0][0];
+            envelope[point][0][1] += instance.envelope[point][0][1];
+        }
+    }
+
+    if (m_bandsRequested && m_busBands > 1 && !m_sharedBuffer.empty())
+    {
+        const AkUInt16 uNumChannels = static_cast<AkUInt16>(std::min<size_t>(m_sharedBuffer.size(), 2));
+        const size_t uFrames = m_sharedBuffer[0].size();
+        const double msWeight = 1.0 / (in_uFrames10ms * uNumChannels);
+        const double* in[2] = { m_sharedBuffer[0].data(), m_sharedBuffer[uNumChannels - 1].data() };
+        double* out[kMaxBands][2];
+        for (AkUInt16 band = 0; band < kMaxBands; ++band)
+        {
+            for (AkUInt16 channel = 0; channel < 2; ++channel)
+            {
+                m_busScratch[band][channel].resize(uFrames);
+                out[band][channel] = m_busScratch[band][channel].data();
+            }
+        }
+        m_busCrossover.Process(in, uNumChannels, static_cast<AkUInt32>(uFrames), out);
+
+        for (AkUInt16 band = 0; band < m_busBands; ++band)
+        {
+            for (AkUInt16 channel = 0; channel < uNumChannels; ++channel)
+            {
+                double& currentMS = m_band_mMS[band][channel];
+                const double startMS = currentMS;
+                size_t frame = 0;
+                for (AkUInt16 point = 0; point < kEnvelopePoints; ++point)
+                {
+                    const AkUInt16 pointFrame = EnvelopeFrame(point + 1, static_cast<AkUInt16>(uFrames));
+                    for (; frame < pointFrame; ++frame)
+                    {
+                        currentMS += (out[band][channel][frame] * out[band][channel][frame] - currentMS) * msWeight;
+                    }
+                    envelope[point][1 + band][channel] = currentMS - (startMS * pow(1.0 - msWeight, static_cast<double>(pointFrame)));
+                }
+            }
+        }
+    }
+    m_bandsRequested = false;
+    std::copy(&envelope[0][0][0], &envelope[0][0][0] + (kEnvelopePoints * kNumKeys * 2), &m_envelopeMS[0][0][0]);
+    const double (&total)[kNumKeys][2] = envelope[kEnvelopePoints - 1];
+
+    for (Instance& instance : m_instances)
+    {
+        for (AkUInt16 key = 0; key < kNumKeys; ++key)
+        {
+            for (AkUInt16 channel = 0; channel < 2; ++channel)
+            {
+                const double others = std::max(total[key][channel] - instance.envelope[kEnvelopePoints - 1][key][channel], 0.0);
+                instance.others_ms[key][channel] = (instance.others_ms[key][channel] * instance.decay[channel]) + others;
+                instance.lastbuffer_looRMS[key][channel] = instance.newbuffer_looRMS[key][channel];
+                instance.newbuffer_looRMS[key][channel] = sqrt(instance.others_ms[key][channel]);
+            }
+        }
+    }
+
+    if (!m_priorityList.empty())
+    {
+        m_minPriority = *std::min_element(m_priorityList.begin(), m_priorityList.end());
+        m_maxPriority = *std::max_element(m_priorityList.begin(), m_priorityList.end());
+    }
+    else
+    {
+        m_minPriority = 1.0;
+        m_maxPriority = 1.0;
+    }
+    m_priorityList.clear();
+    m_sharedBuffer.clear();
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <vector>
+
+// Double-precision model of AutoCompressorFX and its SharedBuffer, written for clarity rather than speed.
+// It follows the plug-in step by step (same tick order, leave-one-out sidechain, priority percentile, envelope,
+// crossover topology) but every intermediate value is a double and every transcendental is the libm double one.
+// Whatever the plug-in does differently from this is rounding, which is what the accuracy harness measures.
+// Only the default detector is modeled: no true peak, hold, auto threshold, culling or quality tiers.
+//
+// When the plug-in's behavior changes on purpose, this model has to change with it.
+
+struct ReferenceParams
+{
+    double threshold = 0.0;
+    double priority = 1.0;
+    double ratio = 1.0;
+    double knee = 0.0;
+    double attack = 0.0;
+    double release = 0.0;
+    AkUInt16 bands = 1;
+    double crossover[3] = { 250.0, 2000.0, 6000.0 };
+    double bandThreshold[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double bandRatio[4] = { 1.0, 1.0, 1.0, 1.0 };
+};
+
+// Linkwitz-Riley crossover with the same band layout as Crossover, one plain biquad cascade per band
+class ReferenceCrossover
+{
+public:
+    static const AkUInt16 kMaxBands = 4;
+
+    void Setup(AkUInt16 in_uBands, const double in_frequencies[kMaxBands - 1], AkUInt32 in_uSampleRate);
+    void Process(const double* const in_ppChannels[2], AkUInt16 in_uNumChannels, AkUInt32 in_uFrames, double* const out_ppBands[kMaxBands][2]);
+
+private:
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+        double z1[2];
+        double z2[2];
+    };
+
+    AkUInt16 m_uBands = 1;
+    std::vector<Biquad> m_chains[kMaxBands];
+};
+
+// One sidechain group: the bus and every instance on it
+class ReferenceGroup
+{
+public:
+    explicit ReferenceGroup(AkUInt32 in_uSampleRate);
+
+    /// Instances have to be added before the first tick and are executed in the order they were added.
+    size_t AddInstance(AkUInt16 in_uNumChannels, const ReferenceParams& in_params);
+
+    /// Same as AutoCompressorFX::Execute: in place on in_ppChannels. Every instance runs once per tick.
+    void Execute(size_t in_instance, double* const* io_ppChannels, AkUInt16 in_uValidFrames);
+
+private:
+    static const AkUInt16 kMaxBands = ReferenceCrossover::kMaxBands;
+    static const AkUInt16 kNumKeys = 1 + kMaxBands;
+    static const AkUInt16 kChunkFrames = 64;
+    static const AkUInt16 kEnvelopePoints = 8;
+
+    struct GainSettings
+    {
+        AkUInt16 key;
+        double thresholdDB;
+        double kneeDB;
+        double realRatio;
+        double attackRate;
+        double releaseRate;
+        double overshootA;
+        double overshootR;
+        double msWeight;
+    };
+
+    struct Instance
+    {
+        ReferenceParams params;
+        AkUInt16 numChannels = 0;
+        double myMS[kNumKeys][2] = {};
+        double lastKeyRMS[kNumKeys][2] = {};
+        double newKeyRMS[kNumKeys][2] = {};
+        double env_target[kMaxBands][2] = {};
+        double env_ratio[kMaxBands][2] = {};
+        double env_output[kMaxBands][2] = {};
+        double env_outputPeak[kMaxBands][2] = {};
+        double sidechainRMS[kNumKeys][2][kEnvelopePoints + 1] = {};
+        AkUInt16 env_state[kMaxBands] = {};
+        ReferenceCrossover crossover;
+        std::vector<double> bandScratch[kMaxBands][2];
+
+        // the instance's slot on the bus
+        double envelope[kEnvelopePoints][kNumKeys][2] = {};    // what its tick added by each envelope point, the last one is the whole tick
+        AkUInt16 envelopeFrames = 0;
+        double decay[2] = { 1.0, 1.0 };
+        double others_ms[kNumKeys][2] = {};
+        double lastbuffer_looRMS[kNumKeys][2] = {};
+        double newbuffer_looRMS[kNumKeys][2] = {};
+    };
+
+    void ProcessGain(Instance& io_instance, const GainSettings& in_settings, AkUInt16 in_uBand, AkUInt16 in_uChannel, double* io_pBuf, AkUInt16 in_uFirstFrame, AkUInt16 in_uFrames, AkUInt16 in_uMaxFrames);
+    void ProcessBands(Instance& io_instance, double* const* io_ppChannels, AkUInt16 in_uValidFrames, const GainSettings in_settings[kMaxBands]);
+    double RatioPercentile(double in_priority) const;
+    void BuildSidechain(Instance& io_instance, double in_msWeight);
+    static AkUInt16 EnvelopeFrame(AkUInt16 in_uPoint, AkUInt16 in_uFrames) { return static_cast<AkUInt16>((in_uPoint * in_uFrames) / kEnvelopePoints); }
+    void CloseTick(AkUInt32 in_uFrames10ms);
+
+    AkUInt32 m_uSampleRate;
+    std::vector<Instance> m_instances;
+    size_t m_executed = 0;
+
+    // the bus
+    std::vector<std::vector<double>> m_sharedBuffer;
+    std::vector<double> m_priorityList;
+    double m_minPriority = 1.0;
+    double m_maxPriority = 1.0;
+    bool m_bandsRequested = false;
+    AkUInt16 m_busBands = 1;
+    ReferenceCrossover m_busCrossover;
+    double m_band_mMS[kMaxBands][2] = {};
+    double m_envelopeMS[kEnvelopePoints][kNumKeys][2] = {};
+    std::vector<double> m_busScratch[kMaxBands][2];
+};
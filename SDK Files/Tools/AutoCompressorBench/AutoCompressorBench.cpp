@@ -0,0 +1,333 @@
+// Micro benchmarks for the AutoCompressor DSP, run on the stand-in host.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O2 -DAK_OPTIMIZED -I"$WWISESDK/include" AutoCompressorBench.cpp ../Common/StandInHost.cpp
+//       $(ls ../../SoundEnginePlugin/*.cpp | grep -v AutoCompressorFXShared) -lpthread -o AutoCompressorBench
+//
+// Every case prints its cost per tick (one buffer of kFrames stereo frames) so they can be compared with each other.
+
+#include "../Common/StandInHost.h"
+#include "../../SoundEnginePlugin/Crossover.h"
+#include "../../SoundEnginePlugin/Decibels.h"
+#include "../../SoundEnginePlugin/GainCurve.h"
+#include "../../SoundEnginePlugin/SharedBuffer.h"
+#include "../../SoundEnginePlugin/SlidingMax.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const AkUInt32 kSampleRate = 48000;
+    const AkUInt16 kFrames = 512;
+    const AkUInt32 kTicks = 2000;
+    const AkUInt32 kHoldWindow = 256;       // values, a hold of about 340 ms in the plug-in's blocks
+
+    struct BenchResult
+    {
+        const char* name;
+        double nsPerTick;
+    };
+
+    // Runs one warm-up pass, then reports the average time of a call to in_tick
+    double TimeTicks(const std::function<void(AkUInt32)>& in_tick)
+    {
+        for (AkUInt32 tick = 0; tick < kTicks / 10; ++tick)
+        {
+            in_tick(tick);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (AkUInt32 tick = 0; tick < kTicks; ++tick)
+        {
+            in_tick(tick);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / kTicks;
+    }
+
+    // Range over the first in_uCount voices of an array
+    struct Voices
+    {
+        Voices(const std::unique_ptr<StandInVoice[]>& in_voices, AkUInt16 in_uCount) : m_pBegin(in_voices.get()), m_pEnd(in_voices.get() + in_uCount) {}
+        StandInVoice* begin() const { return m_pBegin; }
+        StandInVoice* end() const { return m_pEnd; }
+        StandInVoice* m_pBegin;
+        StandInVoice* m_pEnd;
+    };
+
+    // Band-limited noise bursts, loud enough to keep the compressor busy
+    void FillSignal(std::mt19937& io_rng, AkReal32* out_pFrames, AkUInt16 in_uFrames, AkUInt32 in_uTick)
+    {
+        std::uniform_real_distribution<AkReal32> noise(-1.0f, 1.0f);
+        const AkReal32 level = (in_uTick % 8 < 4) ? 0.5f : 0.05f;
+        for (AkUInt16 frame = 0; frame < in_uFrames; ++frame)
+        {
+            out_pFrames[frame] = level * noise(io_rng);
+        }
+    }
+
+    // Voices ducking each other on one group, two is a music-like voice under a dialogue-like one
+    double BenchCompressor(AkInt32 in_iBands, AkInt32 in_iGroup, AkUInt16 in_uVoices = 2, bool in_bTruePeak = false, AkReal32 in_fBudget = 0.0f, AkReal32 in_fHold = 0.0f,
+        bool in_bBatch = false)
+    {
+        StandInAllocator allocator;
+        std::unique_ptr<StandInVoice[]> voices(new StandInVoice[in_uVoices]);
+        std::mt19937 rng(1234);
+        for (StandInVoice& voice : Voices(voices, in_uVoices))
+        {
+            voice.Init(allocator, kSampleRate, 2, kFrames, in_iGroup);
+            voice.SetParam(PARAM_THRESHOLD_ID, -30.0f);
+            voice.SetParam(PARAM_RATIO_ID, 4.0f);
+            voice.SetParam(PARAM_ATTACK_ID, 0.01f);
+            voice.SetParam(PARAM_RELEASE_ID, 0.2f);
+            voice.SetParam(PARAM_BANDS_ID, in_iBands);
+            voice.SetParam(PARAM_TRUE_PEAK_ID, static_cast<AkInt32>(in_bTruePeak));
+            voice.SetParam(PARAM_CPU_BUDGET_ID, in_fBudget);
+            voice.SetParam(PARAM_HOLD_ID, in_fHold);
+            for (AkPluginParamID band = 0; band < static_cast<AkPluginParamID>(MAX_BANDS); ++band)
+            {
+                voice.SetParam(PARAM_BAND1_THRESHOLD_ID + band, -30.0f);
+                voice.SetParam(PARAM_BAND1_RATIO_ID + band, 4.0f);
+            }
+        }
+
+        std::vector<StandInVoice*> batch;
+        for (StandInVoice& voice : Voices(voices, in_uVoices))
+        {
+            batch.push_back(&voice);
+        }
+        const std::vector<AkUInt16> validFrames(in_uVoices, kFrames);
+
+        // per instance, so the result compares with the crossover alone
+        return TimeTicks([&](AkUInt32 tick)
+        {
+            for (StandInVoice& voice : Voices(voices, in_uVoices))
+            {
+                FillSignal(rng, voice.GetChannel(0), kFrames, tick);
+                FillSignal(rng, voice.GetChannel(1), kFrames, tick + 3);
+                if (!in_bBatch)
+                {
+                    voice.Execute(kFrames);
+                }
+            }
+            if (in_bBatch)
+            {
+                StandInVoice::ExecuteBatch(batch.data(), validFrames.data(), in_uVoices);
+            }
+        }) / in_uVoices;
+    }
+
+    // An ambience-heavy group: a few loud voices over many that are 50 dB down, with or without keeping only the loudest
+    double BenchAmbience(AkUInt16 in_uVoices, AkUInt16 in_uLoud, AkInt32 in_iCullKeep, AkInt32 in_iGroup)
+    {
+        StandInAllocator allocator;
+        std::unique_ptr<StandInVoice[]> voices(new StandInVoice[in_uVoices]);
+        std::mt19937 rng(1234);
+        for (StandInVoice& voice : Voices(voices, in_uVoices))
+        {
+            voice.Init(allocator, kSampleRate, 2, kFrames, in_iGroup);
+            voice.SetParam(PARAM_THRESHOLD_ID, -30.0f);
+            voice.SetParam(PARAM_RATIO_ID, 4.0f);
+            voice.SetParam(PARAM_ATTACK_ID, 0.01f);
+            voice.SetParam(PARAM_RELEASE_ID, 0.2f);
+            voice.SetParam(PARAM_CULL_KEEP_ID, in_iCullKeep);
+        }
+
+        return TimeTicks([&](AkUInt32 tick)
+        {
+            AkUInt16 index = 0;
+            for (StandInVoice& voice : Voices(voices, in_uVoices))
+            {
+                const AkReal32 gain = (index++ < in_uLoud) ? 1.0f : 0.003f;
+                for (AkUInt16 channel = 0; channel < 2; ++channel)
+                {
+                    AkReal32* pFrames = voice.GetChannel(channel);
+                    FillSignal(rng, pFrames, kFrames, tick + (3 * channel));
+                    std::transform(pFrames, pFrames + kFrames, pFrames, [gain](AkReal32 x) { return x * gain; });
+                }
+                voice.Execute(kFrames);
+            }
+        }) / in_uVoices;
+    }
+
+    // What closing a tick costs a group with a buffer of stereo noise on it, the RMS detector alone or with the true peak on top
+    double BenchBusDetector(bool in_bTruePeak)
+    {
+        std::unique_ptr<SharedBuffer> bus(new SharedBuffer());
+        const AkUInt16 slot = bus->registerInstance(kSampleRate, kFrames);
+        bus->setDetector(in_bTruePeak);
+
+        std::mt19937 rng(1234);
+        std::vector<AkReal32> storage(2 * kFrames);
+        FillSignal(rng, storage.data(), kFrames, 0);
+        FillSignal(rng, storage.data() + kFrames, kFrames, 3);
+        AkChannelConfig channelConfig;
+        channelConfig.SetStandard(AK_SPEAKER_SETUP_STEREO);
+        AkAudioBuffer buffer;
+        buffer.AttachContiguousDeinterleavedData(storage.data(), kFrames, kFrames, channelConfig);
+
+        return TimeTicks([&](AkUInt32)
+        {
+            bus->addToSharedBuffer(slot, &buffer, kSampleRate);
+            bus->sumContributions();
+            bus->calculatemRMS();
+            bus->calculateTruePeak();
+            bus->resetSharedBuffer();
+        });
+    }
+
+    double BenchCrossover(AkUInt16 in_uBands)
+    {
+        std::unique_ptr<Crossover> crossover(new Crossover());
+        const AkReal32 frequencies[Crossover::kMaxBands - 1] = { 250.0f, 2000.0f, 6000.0f };
+        crossover->setup(in_uBands, frequencies, kSampleRate);
+
+        std::mt19937 rng(1234);
+        std::vector<AkReal32> input[2] = { std::vector<AkReal32>(kFrames), std::vector<AkReal32>(kFrames) };
+        std::vector<AkReal32> output[Crossover::kMaxBands][2];
+        AkReal32* out[Crossover::kMaxBands][2];
+        for (AkUInt16 band = 0; band < Crossover::kMaxBands; ++band)
+        {
+            for (AkUInt16 channel = 0; channel < 2; ++channel)
+            {
+                output[band][channel].resize(kFrames);
+                out[band][channel] = output[band][channel].data();
+            }
+        }
+        FillSignal(rng, input[0].data(), kFrames, 0);
+        FillSignal(rng, input[1].data(), kFrames, 3);
+        const AkReal32* in[2] = { input[0].data(), input[1].data() };
+
+        return TimeTicks([&](AkUInt32)
+        {
+            crossover->process(in, 2, kFrames, out);
+        });
+    }
+
+    // A buffer's worth of levels through a window maximum, the monotonic deque of the hold or a rescan of the whole window.
+    // Falling levels are the deque's worst case, every value stays in it until it slides out of the window.
+    double BenchWindowMax(bool in_bNaive)
+    {
+        std::unique_ptr<SlidingMax> slidingMax(new SlidingMax());
+        slidingMax->setWindow(kHoldWindow);
+        std::vector<AkReal32> window(kHoldWindow, 0.0f);
+        AkUInt32 position = 0;
+        std::vector<AkReal32> levels(kFrames);
+        for (AkUInt16 frame = 0; frame < kFrames; ++frame)
+        {
+            levels[frame] = 1.0f - (static_cast<AkReal32>(frame) / kFrames);
+        }
+
+        volatile AkReal32 sink = 0.0f;
+        return TimeTicks([&](AkUInt32)
+        {
+            AkReal32 sum = 0.0f;
+            for (AkReal32 level : levels)
+            {
+                if (in_bNaive)
+                {
+                    window[position] = level;
+                    position = (position + 1) % kHoldWindow;
+                    sum += *std::max_element(window.begin(), window.end());
+                }
+                else
+                {
+                    sum += slidingMax->push(level);
+                }
+            }
+            sink = sink + sum;
+        });
+    }
+
+    // Sidechain levels spread over and around the knee, so the analytic curve takes every branch
+    std::vector<AkReal32> SidechainLevels(AkReal32 in_fMinDB, AkReal32 in_fMaxDB)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<AkReal32> level(in_fMinDB, in_fMaxDB);
+        std::vector<AkReal32> levels(kFrames);
+        for (AkReal32& value : levels)
+        {
+            value = level(rng);
+        }
+        return levels;
+    }
+
+    // One buffer's worth of a per-sample conversion, the results are summed so they can't be optimized away
+    template <typename Convert>
+    double BenchPerSample(const std::vector<AkReal32>& in_inputs, Convert in_convert)
+    {
+        volatile AkReal32 sink = 0.0f;
+        return TimeTicks([&](AkUInt32)
+        {
+            AkReal32 sum = 0.0f;
+            for (AkReal32 input : in_inputs)
+            {
+                sum += in_convert(input);
+            }
+            sink = sink + sum;
+        });
+    }
+}
+
+int main()
+{
+    std::vector<BenchResult> results;
+
+    const double fullBand = BenchCompressor(1, 0);
+    results.push_back({ "compressor instance, full band", fullBand });
+    results.push_back({ "compressor instance, 4 bands", BenchCompressor(4, 1) });
+    const double sequential128 = BenchCompressor(1, 2, 128);
+    const double batched128 = BenchCompressor(1, 8, 128, false, 0.0f, 0.0f, true);
+    results.push_back({ "compressor instance, 128 on a group", sequential128 });
+    results.push_back({ "compressor instance, 128 batched", batched128 });
+    results.push_back({ "compressor instance, 128 over budget", BenchCompressor(1, 6, 128, false, 1.0f) });
+    results.push_back({ "ambience, 8 loud of 128", BenchAmbience(128, 8, 0, 3) });
+    results.push_back({ "ambience, 8 loud of 128, keep 8", BenchAmbience(128, 8, 8, 4) });
+    results.push_back({ "compressor instance, true peak", BenchCompressor(1, 5, 2, true) });
+    results.push_back({ "compressor instance, 250 ms hold", BenchCompressor(1, 7, 2, false, 0.0f, 0.25f) });
+    const double busRMS = BenchBusDetector(false);
+    const double busTruePeak = BenchBusDetector(true);
+    results.push_back({ "group tick close, RMS", busRMS });
+    results.push_back({ "group tick close, true peak", busTruePeak });
+    const double crossover4 = BenchCrossover(4);
+    results.push_back({ "crossover alone, 2 bands", BenchCrossover(2) });
+    results.push_back({ "crossover alone, 4 bands", crossover4 });
+    const double windowMax = BenchWindowMax(false);
+    const double naiveWindowMax = BenchWindowMax(true);
+    results.push_back({ "window max, monotonic deque", windowMax });
+    results.push_back({ "window max, naive rescan", naiveWindowMax });
+
+    GainCurve gainCurve;
+    gainCurve.setup(-30.0f, 6.0f, 4.0f);
+    const std::vector<AkReal32> levelsDB = SidechainLevels(-60.0f, 0.0f);
+    const std::vector<AkReal32> gainsDB = SidechainLevels(-40.0f, 0.0f);
+    std::vector<AkReal32> levels(levelsDB.size());
+    std::transform(levelsDB.begin(), levelsDB.end(), levels.begin(), [](AkReal32 dB) { return AK_DBTOLIN(dB); });
+
+    results.push_back({ "static curve, analytic", BenchPerSample(levelsDB, [](AkReal32 x) { return GainCurve::analyticGainDB(x, -30.0f, 6.0f, 4.0f); }) });
+    results.push_back({ "static curve, table", BenchPerSample(levelsDB, [&gainCurve](AkReal32 x) { return gainCurve.gainDB(x); }) });
+    results.push_back({ "dB to linear, clamped powf", BenchPerSample(gainsDB, [](AkReal32 x) { return std::clamp(AK_DBTOLIN(x), 0.0f, 1.0f); }) });
+    results.push_back({ "dB to linear, table", BenchPerSample(gainsDB, [](AkReal32 x) { return Decibels::toLinear(x); }) });
+    results.push_back({ "linear to dB, log10f", BenchPerSample(levels, [](AkReal32 x) { return log10f(x) * 20.0f; }) });
+    results.push_back({ "linear to dB, table", BenchPerSample(levels, [](AkReal32 x) { return Decibels::fromLinear(x); }) });
+
+    printf("%-40s %12s\n", "case", "ns/tick");
+    for (const BenchResult& result : results)
+    {
+        printf("%-40s %12.0f\n", result.name, result.nsPerTick);
+    }
+    printf("\n4 band crossover costs %.2fx a full band compressor instance\n", crossover4 / fullBand);
+    printf("the true-peak detector makes a group's tick close %.2fx the RMS one, once per group whatever its instances\n", busTruePeak / busRMS);
+    printf("ExecuteBatch runs 128 instances of a group %.2fx as fast as Execute one at a time\n", sequential128 / batched128);
+    printf("the hold's window max costs %.3fx a rescan of its %u values, per value pushed\n", windowMax / naiveWindowMax, kHoldWindow);
+
+    return 0;
+}
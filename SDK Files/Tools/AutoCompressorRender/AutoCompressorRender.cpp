@@ -0,0 +1,301 @@
+// Offline renderer: runs WAV stems through AutoCompressor instances sharing sidechain groups, faster than real time.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O2 -DAK_OPTIMIZED -I"$WWISESDK/include" AutoCompressorRender.cpp AutomationCurve.cpp
+//       ../Common/StandInHost.cpp ../Common/ParamNames.cpp ../Common/WavFile.cpp
+//       $(ls ../../SoundEnginePlugin/*.cpp | grep -v AutoCompressorFXShared) -lpthread -o AutoCompressorRender
+//
+// Usage:
+//   AutoCompressorRender [--frames N] [--sequential] [--set Name=Value]...
+//       --stem in.wav out.wav [--curve automation.txt] [--set Name=Value]... [--stem ...]
+//
+// Every stem is one voice with its own instance, all running in lockstep one buffer at a time like in the
+// sound engine. --set before the first --stem applies to every stem, after a --stem only to that stem.
+// Each buffer runs every voice through AutoCompressorFX::ExecuteBatch, --sequential calls Execute voice by voice instead.
+// Stems are memory-mapped and streamed, so their length is only bounded by disk space. Outputs are 32-bit float.
+
+#include "AutomationCurve.h"
+#include "../Common/ParamNames.h"
+#include "../Common/StandInHost.h"
+#include "../Common/WavFile.h"
+#include "../../SoundEnginePlugin/TraceRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const AkUInt16 kDefaultFrames = 512;
+    const AkUInt16 kMaxFrames = 8192;
+    const AkUInt32 kReleaseInterval = 64;       // buffers between handing mapped pages back
+
+    struct ParamSetting
+    {
+        const ParamName* param;
+        double value;
+    };
+
+    struct Stem
+    {
+        std::string inputPath;
+        std::string outputPath;
+        std::string curvePath;
+        std::vector<ParamSetting> settings;
+
+        WavReader input;
+        WavWriter output;
+        AutomationCurve curve;
+        StandInVoice voice;
+        std::vector<double> lastValues;         // per parameter ID, so only changes are sent
+        AkUInt64 uNumFrames = 0;
+        bool playing = false;
+    };
+
+    void PrintUsage()
+    {
+        fprintf(stderr,
+            "usage: AutoCompressorRender [--frames N] [--sequential] [--set Name=Value]...\n"
+            "           --stem in.wav out.wav [--curve automation.txt] [--set Name=Value]... [--stem ...]\n"
+            "\n"
+            "  --frames N        buffer size in frames (default %u)\n"
+            "  --sequential      one voice at a time instead of in batches, to compare\n"
+            "  --set Name=Value  parameter value, Name as in AutoCompressor.xml (Threshold, Ratio, Group, Bands, ...)\n"
+            "  --curve file      RTPC automation for the last stem, lines of <seconds> <parameter> <value>\n",
+            kDefaultFrames);
+    }
+
+    bool ParseSetting(const char* in_arg, ParamSetting& out_setting)
+    {
+        const char* separator = strchr(in_arg, '=');
+        if (separator == nullptr)
+        {
+            return false;
+        }
+        out_setting.param = FindParam(std::string(in_arg, separator));
+        char* end = nullptr;
+        out_setting.value = strtod(separator + 1, &end);
+        return out_setting.param != nullptr && end != separator + 1 && *end == '\0';
+    }
+
+    void ApplyParam(Stem& io_stem, const ParamName& in_param, double in_value)
+    {
+        double& last = io_stem.lastValues[in_param.id];
+        if (last == in_value)
+        {
+            return;
+        }
+        last = in_value;
+        if (in_param.isInt)
+        {
+            io_stem.voice.SetParam(in_param.id, static_cast<AkInt32>(in_value));
+        }
+        else
+        {
+            io_stem.voice.SetParam(in_param.id, static_cast<AkReal32>(in_value));
+        }
+    }
+
+    bool ParseArguments(int argc, char** argv, AkUInt16& out_uFrames, bool& out_bSequential, std::vector<std::unique_ptr<Stem>>& out_stems)
+    {
+        std::vector<ParamSetting> shared;
+        for (int arg = 1; arg < argc; ++arg)
+        {
+            const std::string option = argv[arg];
+            const bool hasValue = arg + 1 < argc;
+            if (option == "--frames" && hasValue)
+            {
+                const long frames = strtol(argv[++arg], nullptr, 10);
+                if (frames < 1 || frames > kMaxFrames)
+                {
+                    fprintf(stderr, "--frames has to be between 1 and %u\n", kMaxFrames);
+                    return false;
+                }
+                out_uFrames = static_cast<AkUInt16>(frames);
+            }
+            else if (option == "--sequential")
+            {
+                out_bSequential = true;
+            }
+            else if (option == "--set" && hasValue)
+            {
+                ParamSetting setting;
+                if (!ParseSetting(argv[++arg], setting))
+                {
+                    fprintf(stderr, "bad --set %s\n", argv[arg]);
+                    return false;
+                }
+                (out_stems.empty() ? shared : out_stems.back()->settings).push_back(setting);
+            }
+            else if (option == "--stem" && arg + 2 < argc)
+            {
+                out_stems.emplace_back(new Stem());
+                out_stems.back()->inputPath = argv[++arg];
+                out_stems.back()->outputPath = argv[++arg];
+                out_stems.back()->settings = shared;
+            }
+            else if (option == "--curve" && hasValue && !out_stems.empty())
+            {
+                out_stems.back()->curvePath = argv[++arg];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return !out_stems.empty();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    AkUInt16 uFrames = kDefaultFrames;
+    bool bSequential = false;
+    std::vector<std::unique_ptr<Stem>> stems;
+    if (!ParseArguments(argc, argv, uFrames, bSequential, stems))
+    {
+        PrintUsage();
+        return 2;
+    }
+    TraceRecorder::get().startFromEnvironment();
+
+    std::string error;
+    AkUInt32 uSampleRate = 0;
+    AkUInt64 uLongest = 0;
+    for (std::unique_ptr<Stem>& stem : stems)
+    {
+        if (!stem->input.Open(stem->inputPath, error) || (!stem->curvePath.empty() && !stem->curve.Load(stem->curvePath, error)))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        if (uSampleRate != 0 && stem->input.SampleRate() != uSampleRate)
+        {
+            fprintf(stderr, "%s: all stems need the same sample rate (%u Hz)\n", stem->inputPath.c_str(), uSampleRate);
+            return 1;
+        }
+        uSampleRate = stem->input.SampleRate();
+        stem->uNumFrames = stem->input.NumFrames();
+        uLongest = std::max(uLongest, stem->uNumFrames);
+    }
+
+    StandInAllocator allocator;
+    std::vector<AutomationCurve::Value> automation;
+    for (std::unique_ptr<Stem>& stem : stems)
+    {
+        if (!stem->output.Create(stem->outputPath, stem->input.NumChannels(), uSampleRate, stem->uNumFrames, error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+
+        // the group has to be known before Init to register on the right bus, the rest can follow
+        AkInt32 iGroup = 0;
+        for (const ParamSetting& setting : stem->settings)
+        {
+            iGroup = (setting.param->id == PARAM_GROUP_ID) ? static_cast<AkInt32>(setting.value) : iGroup;
+        }
+        if (!stem->voice.Init(allocator, uSampleRate, stem->input.NumChannels(), uFrames, iGroup))
+        {
+            fprintf(stderr, "%s: the plug-in failed to initialize\n", stem->inputPath.c_str());
+            return 1;
+        }
+
+        stem->lastValues.assign(NUM_PARAMS, std::nan(""));
+        stem->lastValues[PARAM_GROUP_ID] = iGroup;
+        for (const ParamSetting& setting : stem->settings)
+        {
+            ApplyParam(*stem, *setting.param, setting.value);
+        }
+        stem->playing = true;
+    }
+
+    std::vector<Stem*> running;
+    std::vector<StandInVoice*> voices;
+    std::vector<AkUInt16> validFrames;
+    auto start = std::chrono::steady_clock::now();
+    AkUInt32 uBuffer = 0;
+    for (AkUInt64 uFrame = 0; uFrame < uLongest; uFrame += uFrames, ++uBuffer)
+    {
+        const double time = static_cast<double>(uFrame) / uSampleRate;
+        running.clear();
+        voices.clear();
+        validFrames.clear();
+        for (std::unique_ptr<Stem>& stem : stems)
+        {
+            if (!stem->playing)
+            {
+                continue;
+            }
+
+            // A stem that ran out stops its voice, like a sound that finished playing,
+            // so it leaves the sidechain of the others instead of holding them with silence
+            if (uFrame >= stem->uNumFrames)
+            {
+                stem->voice.Term();
+                stem->output.Close();
+                stem->input.Close();
+                stem->playing = false;
+                continue;
+            }
+
+            stem->curve.Evaluate(time, automation);
+            for (const AutomationCurve::Value& value : automation)
+            {
+                ApplyParam(*stem, *value.param, value.value);
+            }
+
+            const AkUInt16 uValidFrames = static_cast<AkUInt16>(std::min<AkUInt64>(uFrames, stem->uNumFrames - uFrame));
+            AkReal32* channels[2] = { stem->voice.GetChannel(0), stem->voice.NumChannels() > 1 ? stem->voice.GetChannel(1) : nullptr };
+            stem->input.ReadFrames(uFrame, uValidFrames, channels);
+            running.push_back(stem.get());
+            voices.push_back(&stem->voice);
+            validFrames.push_back(uValidFrames);
+        }
+
+        if (bSequential)
+        {
+            for (size_t uVoice = 0; uVoice < voices.size(); ++uVoice)
+            {
+                voices[uVoice]->Execute(validFrames[uVoice]);
+            }
+        }
+        else
+        {
+            StandInVoice::ExecuteBatch(voices.data(), validFrames.data(), static_cast<AkUInt16>(voices.size()));
+        }
+
+        for (size_t uVoice = 0; uVoice < running.size(); ++uVoice)
+        {
+            Stem* stem = running[uVoice];
+            AkReal32* channels[2] = { stem->voice.GetChannel(0), stem->voice.NumChannels() > 1 ? stem->voice.GetChannel(1) : nullptr };
+            stem->output.WriteFrames(uFrame, validFrames[uVoice], channels);
+
+            if (uBuffer % kReleaseInterval == 0)
+            {
+                stem->input.Release(uFrame);
+                stem->output.Release(uFrame);
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double stemSeconds = 0.0;
+    for (std::unique_ptr<Stem>& stem : stems)
+    {
+        stemSeconds += static_cast<double>(stem->uNumFrames) / uSampleRate;
+        stem->voice.Term();
+        stem->output.Close();
+    }
+
+    const double audioSeconds = static_cast<double>(uLongest) / uSampleRate;
+    printf("rendered %zu stem(s), %.1f s of audio (%.1f s of stems) in %.2f s: %.0fx real time\n",
+        stems.size(), audioSeconds, stemSeconds, seconds, audioSeconds / std::max(seconds, 1e-9));
+    return 0;
+}
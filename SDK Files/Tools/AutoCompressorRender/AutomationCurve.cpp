@@ -0,0 +1,87 @@
+#include "AutomationCurve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+bool AutomationCurve::Load(const std::string& in_path, std::string& out_error)
+{
+    std::ifstream file(in_path);
+    if (!file)
+    {
+        out_error = in_path + ": can't be opened";
+        return false;
+    }
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        double time, value;
+        std::string name;
+        if (!(fields >> time))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+            {
+                continue;
+            }
+            out_error = in_path + ":" + std::to_string(lineNumber) + ": expected <seconds> <parameter> <value>";
+            return false;
+        }
+        if (!(fields >> name >> value))
+        {
+            out_error = in_path + ":" + std::to_string(lineNumber) + ": expected <seconds> <parameter> <value>";
+            return false;
+        }
+
+        const ParamName* param = FindParam(name);
+        if (param == nullptr)
+        {
+            out_error = in_path + ":" + std::to_string(lineNumber) + ": unknown parameter " + name;
+            return false;
+        }
+
+        auto lane = std::find_if(m_lanes.begin(), m_lanes.end(), [param](const Lane& in_lane) { return in_lane.param == param; });
+        if (lane == m_lanes.end())
+        {
+            m_lanes.push_back({ param, {} });
+            lane = m_lanes.end() - 1;
+        }
+        lane->points.push_back({ time, value });
+    }
+
+    // stable, so two breakpoints at the same time make a step
+    for (Lane& lane : m_lanes)
+    {
+        std::stable_sort(lane.points.begin(), lane.points.end(), [](const Point& a, const Point& b) { return a.time < b.time; });
+    }
+    return true;
+}
+
+void AutomationCurve::Evaluate(double in_time, std::vector<Value>& out_values) const
+{
+    out_values.clear();
+    for (const Lane& lane : m_lanes)
+    {
+        const std::vector<Point>& points = lane.points;
+        if (lane.cursor > 0 && points[lane.cursor].time > in_time)
+        {
+            lane.cursor = 0;        // went back in time
+        }
+        while (lane.cursor + 1 < points.size() && points[lane.cursor + 1].time <= in_time)
+        {
+            ++lane.cursor;
+        }
+
+        const Point& from = points[lane.cursor];
+        double value = from.value;
+        if (in_time > from.time && lane.cursor + 1 < points.size())
+        {
+            const Point& to = points[lane.cursor + 1];
+            value += (to.value - from.value) * (in_time - from.time) / (to.time - from.time);
+        }
+        out_values.push_back({ lane.param, lane.param->isInt ? std::round(value) : value });
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../Common/ParamNames.h"
+
+#include <string>
+#include <vector>
+
+// RTPC automation for one stem, read from a text file with one breakpoint per line:
+//
+//   # seconds  parameter  value
+//   0.0        Threshold  -30
+//   12.5       Threshold  -18
+//   12.5       Bands      3
+//
+// Parameter names are the ones of AutoCompressor.xml. Values are linearly interpolated between breakpoints
+// of the same parameter and hold before the first and after the last one. Int parameters are rounded.
+
+class AutomationCurve
+{
+public:
+    bool Load(const std::string& in_path, std::string& out_error);
+
+    struct Value
+    {
+        const ParamName* param;
+        double value;
+    };
+
+    /// Value of every automated parameter at in_time (in seconds).
+    void Evaluate(double in_time, std::vector<Value>& out_values) const;
+
+private:
+    struct Point
+    {
+        double time;
+        double value;
+    };
+
+    struct Lane
+    {
+        const ParamName* param;
+        std::vector<Point> points;     // sorted by time
+        mutable size_t cursor = 0;     // renders only move forward, so lookups start from the last segment
+    };
+
+    std::vector<Lane> m_lanes;
+};
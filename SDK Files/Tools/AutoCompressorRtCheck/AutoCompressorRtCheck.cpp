@@ -0,0 +1,552 @@
+// Real-time safety check: runs the plug-in through scenarios that reach every path of Execute, ExecuteBatch and TimeSkip,
+// with the C allocator and the pthread locks interposed, and records every allocation, free and lock taken from inside
+// those calls along with the call stack it came from. Exits with 1 when it finds any, so it can run in CI next to
+// AutoCompressorAccuracy.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O1 -g -fsanitize=bounds -fno-sanitize-recover=bounds -DAK_OPTIMIZED -I"$WWISESDK/include" AutoCompressorRtCheck.cpp ../Common/StandInHost.cpp
+//       $(ls ../../SoundEnginePlugin/*.cpp | grep -v AutoCompressorFXShared) -rdynamic -ldl -lpthread -o AutoCompressorRtCheck
+//
+// Usage:
+//   AutoCompressorRtCheck [--scenario name]...
+//
+// operator new and delete come down to malloc and free in libstdc++, and std::mutex and std::shared_mutex to the pthread
+// mutex and rwlock calls, so interposing those covers both the C and the C++ ways in.
+//
+// Locks of a bus's SharedBuffer::mtx get a column of their own, so a new lock site on the audio path shows which kind it is,
+// and fail like every other lock: only registering an instance from Init takes it.
+//
+// The plug-in keeps state for a left and a right only. Scenarios with more channels check that the ones past the second come
+// out as they went in, and the bounds sanitizer in the build line stops the check at the first index past that state.
+//
+// Not covered: the stand-in host has no plugin context, so the monitor data isn't posted.
+
+#include "../Common/StandInHost.h"
+#include "../../SoundEnginePlugin/SharedBuffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+    void* __libc_malloc(size_t in_uSize);
+    void* __libc_calloc(size_t in_uCount, size_t in_uSize);
+    void* __libc_realloc(void* in_pMemAddress, size_t in_uSize);
+    void* __libc_memalign(size_t in_uAlignment, size_t in_uSize);
+    void __libc_free(void* in_pMemAddress);
+}
+
+namespace
+{
+    enum EventKind
+    {
+        event_alloc = 0,
+        event_free,
+        event_lock,
+        event_busLock,                          // SharedBuffer::mtx of one of the groups' busses
+        numEventKinds
+    };
+    const char* const kEventNames[numEventKinds] = { "allocation", "free", "lock", "bus lock" };
+
+    const AkUInt32 kSampleRate = 48000;
+    const AkUInt32 kOtherSampleRate = 44100;
+    const AkUInt16 kFrames = 512;
+    const AkUInt32 kTicks = 200;
+
+    const int kSiteFrames = 16;                 // frames of call stack kept per site
+    const int kHookFrames = 2;                  // Record and the interposed function, left out of the sites
+    const AkUInt32 kMaxSites = 256;
+
+    struct Site
+    {
+        EventKind kind;
+        const char* scenario;
+        AkUInt32 count;
+        int depth;
+        void* frames[kSiteFrames];
+    };
+
+    // Only the thread running the scenarios records, and only while it is inside the plug-in, so none of this needs to be atomic
+    thread_local bool t_bInScope = false;
+    thread_local bool t_bInHook = false;        // backtrace() and the lookups below can come back into the hooks
+    const char* g_pszScenario = "";
+    Site g_sites[kMaxSites];
+    AkUInt32 g_uNumSites = 0;
+    AkUInt32 g_uDroppedSites = 0;
+    AkUInt32 g_callEvents[numEventKinds] = {};  // of the call in progress
+
+    bool IsBusMutex(const void* in_pMutex)
+    {
+        const char* pMutex = static_cast<const char*>(in_pMutex);
+        for (AkInt32 iGroup = 0; iGroup < GlobalManager::kNumGroups; ++iGroup)
+        {
+            const char* pBus = reinterpret_cast<const char*>(GlobalManager::getGlobalSharedBuffer(iGroup));
+            if (pMutex >= pBus && pMutex < pBus + sizeof(SharedBuffer))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Record(EventKind in_kind, const void* in_pMutex = nullptr)
+    {
+        if (!t_bInScope || t_bInHook)
+        {
+            return;
+        }
+        t_bInHook = true;
+
+        if (in_kind == event_lock && IsBusMutex(in_pMutex))
+        {
+            in_kind = event_busLock;
+        }
+        g_callEvents[in_kind]++;
+
+        void* frames[kSiteFrames + kHookFrames];
+        const int depth = AkMax(backtrace(frames, kSiteFrames + kHookFrames) - kHookFrames, 0);
+        void* const* pFrames = frames + kHookFrames;
+
+        Site* pSite = std::find_if(g_sites, g_sites + g_uNumSites, [&](const Site& site)
+        {
+            return site.kind == in_kind && site.scenario == g_pszScenario && site.depth == depth && std::equal(pFrames, pFrames + depth, site.frames);
+        });
+        if (pSite != g_sites + g_uNumSites)
+        {
+            pSite->count++;
+        }
+        else if (g_uNumSites < kMaxSites)
+        {
+            pSite = &g_sites[g_uNumSites++];
+            pSite->kind = in_kind;
+            pSite->scenario = g_pszScenario;
+            pSite->count = 1;
+            pSite->depth = depth;
+            std::copy(pFrames, pFrames + depth, pSite->frames);
+        }
+        else
+        {
+            g_uDroppedSites++;
+        }
+
+        t_bInHook = false;
+    }
+
+    template <typename Function>
+    Function Next(Function& io_pFunction, const char* in_pszName)
+    {
+        if (io_pFunction == nullptr)
+        {
+            io_pFunction = reinterpret_cast<Function>(dlsym(RTLD_NEXT, in_pszName));
+        }
+        return io_pFunction;
+    }
+
+    int (*g_pMutexLock)(pthread_mutex_t*) = nullptr;
+    int (*g_pMutexTryLock)(pthread_mutex_t*) = nullptr;
+    int (*g_pRwLockRdLock)(pthread_rwlock_t*) = nullptr;
+    int (*g_pRwLockWrLock)(pthread_rwlock_t*) = nullptr;
+    int (*g_pRwLockTryRdLock)(pthread_rwlock_t*) = nullptr;
+    int (*g_pRwLockTryWrLock)(pthread_rwlock_t*) = nullptr;
+
+    // Resolved up front, dlsym can allocate the first time round
+    void ResolveHooks()
+    {
+        Next(g_pMutexLock, "pthread_mutex_lock");
+        Next(g_pMutexTryLock, "pthread_mutex_trylock");
+        Next(g_pRwLockRdLock, "pthread_rwlock_rdlock");
+        Next(g_pRwLockWrLock, "pthread_rwlock_wrlock");
+        Next(g_pRwLockTryRdLock, "pthread_rwlock_tryrdlock");
+        Next(g_pRwLockTryWrLock, "pthread_rwlock_trywrlock");
+
+        // the first backtrace() loads the unwinder
+        void* frames[kSiteFrames];
+        backtrace(frames, kSiteFrames);
+    }
+}
+
+// The interposed functions. The executable's definitions win over the C library's for every module, the C++ runtime included.
+extern "C"
+{
+    void* malloc(size_t in_uSize) noexcept
+    {
+        Record(event_alloc);
+        return __libc_malloc(in_uSize);
+    }
+
+    void* calloc(size_t in_uCount, size_t in_uSize) noexcept
+    {
+        Record(event_alloc);
+        return __libc_calloc(in_uCount, in_uSize);
+    }
+
+    void* realloc(void* in_pMemAddress, size_t in_uSize) noexcept
+    {
+        Record(event_alloc);
+        return __libc_realloc(in_pMemAddress, in_uSize);
+    }
+
+    void* memalign(size_t in_uAlignment, size_t in_uSize) noexcept
+    {
+        Record(event_alloc);
+        return __libc_memalign(in_uAlignment, in_uSize);
+    }
+
+    void* aligned_alloc(size_t in_uAlignment, size_t in_uSize) noexcept
+    {
+        Record(event_alloc);
+        return __libc_memalign(in_uAlignment, in_uSize);
+    }
+
+    int posix_memalign(void** out_ppMemAddress, size_t in_uAlignment, size_t in_uSize) noexcept
+    {
+        Record(event_alloc);
+        *out_ppMemAddress = __libc_memalign(in_uAlignment, in_uSize);
+        return (*out_ppMemAddress != nullptr) ? 0 : ENOMEM;
+    }
+
+    void free(void* in_pMemAddress) noexcept
+    {
+        if (in_pMemAddress != nullptr)
+        {
+            Record(event_free);
+        }
+        __libc_free(in_pMemAddress);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* io_pMutex) noexcept
+    {
+        Record(event_lock, io_pMutex);
+        return Next(g_pMutexLock, "pthread_mutex_lock")(io_pMutex);
+    }
+
+    int pthread_mutex_trylock(pthread_mutex_t* io_pMutex) noexcept
+    {
+        Record(event_lock, io_pMutex);
+        return Next(g_pMutexTryLock, "pthread_mutex_trylock")(io_pMutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* io_pLock) noexcept
+    {
+        Record(event_lock, io_pLock);
+        return Next(g_pRwLockRdLock, "pthread_rwlock_rdlock")(io_pLock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* io_pLock) noexcept
+    {
+        Record(event_lock, io_pLock);
+        return Next(g_pRwLockWrLock, "pthread_rwlock_wrlock")(io_pLock);
+    }
+
+    int pthread_rwlock_tryrdlock(pthread_rwlock_t* io_pLock) noexcept
+    {
+        Record(event_lock, io_pLock);
+        return Next(g_pRwLockTryRdLock, "pthread_rwlock_tryrdlock")(io_pLock);
+    }
+
+    int pthread_rwlock_trywrlock(pthread_rwlock_t* io_pLock) noexcept
+    {
+        Record(event_lock, io_pLock);
+        return Next(g_pRwLockTryWrLock, "pthread_rwlock_trywrlock")(io_pLock);
+    }
+}
+
+namespace
+{
+    struct ScenarioResult
+    {
+        AkUInt32 calls = 0;
+        AkUInt32 events[numEventKinds] = {};
+        AkUInt32 changedChannels = 0;           // channels past the second the plug-in wrote to, over every call
+    };
+
+    // Records what the plug-in does for as long as it lives, around one call into it
+    class RtScope
+    {
+    public:
+        explicit RtScope(ScenarioResult& io_result) : m_result(io_result)
+        {
+            std::fill(g_callEvents, g_callEvents + numEventKinds, 0);
+            t_bInScope = true;
+        }
+        ~RtScope()
+        {
+            t_bInScope = false;
+            m_result.calls++;
+            for (int kind = 0; kind < numEventKinds; ++kind)
+            {
+                m_result.events[kind] += g_callEvents[kind];
+            }
+        }
+
+    private:
+        ScenarioResult& m_result;
+    };
+
+    enum CallMode
+    {
+        call_execute = 0,
+        call_batch,                             // the whole group in one AutoCompressorFX::ExecuteBatch
+        call_timeSkip                           // every fourth tick is skipped instead of executed
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        const char* description;
+        AkUInt16 voices;
+        AkUInt16 channels;
+        CallMode mode;
+        bool mixedRates;                        // every other voice at kOtherSampleRate, resampled onto the bus's grid
+        bool partialBuffers;                    // buffers from a quarter to all of kFrames, as at the end of a sound
+        void (*setup)(StandInVoice& io_voice, AkUInt16 in_uVoice);
+        void (*change)(StandInVoice& io_voice, AkUInt16 in_uVoice, AkInt32 in_iGroup, AkUInt32 in_uTick);     // parameter changes during playback, may be null
+    };
+
+    void SetBands(StandInVoice& io_voice, AkInt32 in_iBands)
+    {
+        io_voice.SetParam(PARAM_BANDS_ID, in_iBands);
+        for (AkPluginParamID band = 0; band < static_cast<AkPluginParamID>(MAX_BANDS); ++band)
+        {
+            io_voice.SetParam(PARAM_BAND1_THRESHOLD_ID + band, -30.0f);
+            io_voice.SetParam(PARAM_BAND1_RATIO_ID + band, 4.0f);
+        }
+    }
+
+    const Scenario kScenarios[] =
+    {
+        { "full_band", "4 voices, RMS detector", 4, 2, call_execute, false, false,
+            [](StandInVoice&, AkUInt16) {}, nullptr },
+        { "multiband", "3 voices split in 4 bands next to a full band one", 4, 2, call_execute, false, false,
+            [](StandInVoice& voice, AkUInt16 uVoice) { SetBands(voice, (uVoice == 0) ? 1 : 4); }, nullptr },
+        { "auto_threshold", "4 voices with the threshold following the group", 4, 2, call_execute, false, false,
+            [](StandInVoice& voice, AkUInt16) { voice.SetParam(PARAM_AUTO_THRESHOLD_ID, 1); voice.SetParam(PARAM_AUTO_HORIZON_ID, 0.5f); }, nullptr },
+        { "culling", "12 voices, only the 3 loudest take part", 12, 2, call_execute, false, false,
+            [](StandInVoice& voice, AkUInt16) { voice.SetParam(PARAM_CULL_KEEP_ID, 3); voice.SetParam(PARAM_CULL_BELOW_ID, -40.0f); }, nullptr },
+        { "true_peak", "4 voices, true-peak detector on the group", 4, 2, call_execute, false, false,
+            [](StandInVoice& voice, AkUInt16) { voice.SetParam(PARAM_TRUE_PEAK_ID, 1); }, nullptr },
+        { "hold", "4 voices with a 250 ms sidechain hold", 4, 2, call_execute, false, false,
+            [](StandInVoice& voice, AkUInt16) { voice.SetParam(PARAM_HOLD_ID, 0.25f); }, nullptr },
+        { "cpu_budget", "4 voices over a 1 us budget, stepping down tiers", 4, 2, call_execute, false, false,
+            [](StandInVoice& voice, AkUInt16) { voice.SetParam(PARAM_CPU_BUDGET_ID, 1.0f); }, nullptr },
+        { "batch", "9 voices through ExecuteBatch, 1 of them multiband", 9, 2, call_batch, false, false,
+            [](StandInVoice& voice, AkUInt16 uVoice) { SetBands(voice, (uVoice == 4) ? 3 : 1); }, nullptr },
+        { "batch_5_1", "9 voices in 5.1 through ExecuteBatch, 1 of them multiband", 9, 6, call_batch, false, false,
+            [](StandInVoice& voice, AkUInt16 uVoice) { SetBands(voice, (uVoice == 4) ? 3 : 1); }, nullptr },
+        { "mixed_rates", "4 voices, half of them at 44.1 kHz on a 48 kHz bus", 4, 2, call_execute, true, false,
+            [](StandInVoice& voice, AkUInt16) { SetBands(voice, 2); }, nullptr },
+        { "partial", "4 voices with short buffers, and ticks skipped", 4, 2, call_timeSkip, false, true,
+            [](StandInVoice&, AkUInt16) {}, nullptr },
+        { "param_changes", "4 voices whose bands, detector, hold, culling and budget change while they play", 4, 2, call_execute, false, false,
+            [](StandInVoice&, AkUInt16) {},
+            [](StandInVoice& voice, AkUInt16, AkInt32, AkUInt32 tick)
+            {
+                if (tick % 20 == 10)
+                {
+                    const AkInt32 iStep = static_cast<AkInt32>(tick / 20);
+                    SetBands(voice, 1 + (iStep % MAX_BANDS));
+                    voice.SetParam(PARAM_TRUE_PEAK_ID, iStep % 2);
+                    voice.SetParam(PARAM_AUTO_THRESHOLD_ID, (iStep / 2) % 2);
+                    voice.SetParam(PARAM_HOLD_ID, 0.05f * (iStep % 3));
+                    voice.SetParam(PARAM_CULL_KEEP_ID, iStep % 3);
+                    voice.SetParam(PARAM_CPU_BUDGET_ID, (iStep % 4 == 3) ? 1.0f : 0.0f);
+                }
+            } },
+        // more voices than a chunk of slots, so the empty group takes both spare chunks to fit them
+        { "group_change", "20 voices moving to a group nobody else uses and back, over a few ticks", 20, 2, call_execute, false, false,
+            [](StandInVoice&, AkUInt16) {},
+            [](StandInVoice& voice, AkUInt16 uVoice, AkInt32 iGroup, AkUInt32 tick)
+            {
+                const AkUInt32 uPhase = tick + (uVoice % 5);
+                if (uPhase % 40 == 10)
+                {
+                    voice.SetParam(PARAM_GROUP_ID, (uPhase / 40) % 2 == 0 ? GlobalManager::kNumGroups - 1 : iGroup);
+                }
+            } },
+    };
+
+    // Noise bursts at a different level per voice, so the envelopes, the culling and the priority range all move
+    void FillSignal(AkUInt32& io_uSeed, AkReal32* out_pFrames, AkUInt16 in_uFrames, AkUInt32 in_uTick, AkUInt16 in_uVoice)
+    {
+        const AkReal32 level = ((in_uTick + in_uVoice) % 8 < 4) ? 0.5f : 0.02f;
+        const AkReal32 voiceGain = powf(0.5f, static_cast<AkReal32>(in_uVoice % 6));
+        for (AkUInt16 frame = 0; frame < in_uFrames; ++frame)
+        {
+            io_uSeed = (io_uSeed * 1664525u) + 1013904223u;
+            out_pFrames[frame] = level * voiceGain * ((static_cast<AkReal32>(io_uSeed >> 8) / 8388608.0f) - 1.0f);
+        }
+    }
+
+    ScenarioResult RunScenario(const Scenario& in_scenario, AkInt32 in_iGroup)
+    {
+        StandInAllocator allocator;
+        std::vector<StandInVoice> voices(in_scenario.voices);
+        for (AkUInt16 uVoice = 0; uVoice < in_scenario.voices; ++uVoice)
+        {
+            StandInVoice& voice = voices[uVoice];
+            const AkUInt32 uSampleRate = (in_scenario.mixedRates && uVoice % 2 == 1) ? kOtherSampleRate : kSampleRate;
+            voice.Init(allocator, uSampleRate, in_scenario.channels, kFrames, in_iGroup);
+            voice.SetParam(PARAM_THRESHOLD_ID, -30.0f);
+            voice.SetParam(PARAM_RATIO_ID, 4.0f);
+            voice.SetParam(PARAM_ATTACK_ID, 0.01f);
+            voice.SetParam(PARAM_RELEASE_ID, 0.2f);
+            voice.SetParam(PARAM_PRIORITY_ID, static_cast<AkReal32>(1 + (uVoice % 5)));
+            in_scenario.setup(voice, uVoice);
+        }
+
+        // everything the calls take is set up out here, so the scope only sees the plug-in
+        std::vector<AutoCompressorFX*> plugins;
+        std::vector<AkAudioBuffer*> buffers;
+        for (StandInVoice& voice : voices)
+        {
+            plugins.push_back(voice.Plugin());
+            buffers.push_back(voice.Buffer());
+        }
+        const AkUInt16 uExtraChannels = static_cast<AkUInt16>(AkMax(in_scenario.channels, 2) - 2);
+        std::vector<AkReal32> extraInput(static_cast<size_t>(in_scenario.voices) * uExtraChannels * kFrames);
+
+        ScenarioResult result;
+        g_pszScenario = in_scenario.name;
+        AkUInt32 uSeed = 1234;
+        for (AkUInt32 tick = 0; tick < kTicks; ++tick)
+        {
+            const AkUInt16 uValidFrames = in_scenario.partialBuffers ? static_cast<AkUInt16>(kFrames / 4 + ((tick * 97) % (3 * kFrames / 4 + 1))) : kFrames;
+            for (AkUInt16 uVoice = 0; uVoice < in_scenario.voices; ++uVoice)
+            {
+                StandInVoice& voice = voices[uVoice];
+                if (in_scenario.change != nullptr)
+                {
+                    in_scenario.change(voice, uVoice, in_iGroup, tick);
+                }
+                for (AkUInt16 uChannel = 0; uChannel < in_scenario.channels; ++uChannel)
+                {
+                    FillSignal(uSeed, voice.GetChannel(uChannel), kFrames, tick + (3 * uChannel), uVoice);
+                }
+                for (AkUInt16 uExtra = 0; uExtra < uExtraChannels; ++uExtra)
+                {
+                    const AkReal32* pChannel = voice.GetChannel(2 + uExtra);
+                    std::copy(pChannel, pChannel + kFrames, extraInput.begin() + ((static_cast<size_t>(uVoice) * uExtraChannels + uExtra) * kFrames));
+                }
+                buffers[uVoice]->uValidFrames = uValidFrames;
+            }
+
+            if (in_scenario.mode == call_batch)
+            {
+                RtScope scope(result);
+                AutoCompressorFX::ExecuteBatch(plugins.data(), buffers.data(), in_scenario.voices);
+            }
+            else
+            {
+                for (AkUInt16 uVoice = 0; uVoice < in_scenario.voices; ++uVoice)
+                {
+                    RtScope scope(result);
+                    if (in_scenario.mode == call_timeSkip && tick % 4 == 3)
+                    {
+                        plugins[uVoice]->TimeSkip(uValidFrames);
+                    }
+                    else
+                    {
+                        plugins[uVoice]->Execute(buffers[uVoice]);
+                    }
+                }
+            }
+
+            for (AkUInt16 uVoice = 0; uVoice < in_scenario.voices; ++uVoice)
+            {
+                for (AkUInt16 uExtra = 0; uExtra < uExtraChannels; ++uExtra)
+                {
+                    const AkReal32* pChannel = voices[uVoice].GetChannel(2 + uExtra);
+                    if (!std::equal(pChannel, pChannel + kFrames, extraInput.begin() + ((static_cast<size_t>(uVoice) * uExtraChannels + uExtra) * kFrames)))
+                    {
+                        result.changedChannels++;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    void PrintSite(const Site& in_site)
+    {
+        printf("\n%s in %s, %u times:\n", kEventNames[in_site.kind], in_site.scenario, in_site.count);
+        for (int frame = 0; frame < in_site.depth; ++frame)
+        {
+            Dl_info info = {};
+            std::string symbol = "??";
+            uintptr_t offset = 0;
+            if (dladdr(in_site.frames[frame], &info) != 0 && info.dli_sname != nullptr)
+            {
+                int status = 0;
+                char* pszDemangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                symbol = (status == 0) ? pszDemangled : info.dli_sname;
+                ::free(pszDemangled);
+                offset = reinterpret_cast<uintptr_t>(in_site.frames[frame]) - reinterpret_cast<uintptr_t>(info.dli_saddr);
+            }
+            const char* pszModule = (info.dli_fname != nullptr) ? strrchr(info.dli_fname, '/') : nullptr;
+            printf("    #%-2d %s+0x%llx (%s)\n", frame, symbol.c_str(), static_cast<unsigned long long>(offset),
+                (pszModule != nullptr) ? pszModule + 1 : "?");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> selected;
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        const std::string option = argv[arg];
+        if (option == "--scenario" && arg + 1 < argc)
+        {
+            selected.push_back(argv[++arg]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: AutoCompressorRtCheck [--scenario name]...\n");
+            return 2;
+        }
+    }
+
+    ResolveHooks();
+    printf("%-16s %-80s %7s %7s %7s %7s %10s\n", "scenario", "", "calls", "allocs", "frees", "locks", "bus locks");
+
+    bool passed = true;
+    AkInt32 iGroup = 0;
+    for (const Scenario& scenario : kScenarios)
+    {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), scenario.name) == selected.end())
+        {
+            continue;
+        }
+
+        // a group of its own, so every scenario starts on a bus that has never been used
+        const ScenarioResult result = RunScenario(scenario, iGroup++);
+        const bool safe = std::all_of(result.events, result.events + numEventKinds, [](AkUInt32 count) { return count == 0; });
+        passed = passed && safe && result.changedChannels == 0;
+        printf("%-16s %-80s %7u %7u %7u %7u %10u  %s\n", scenario.name, scenario.description, result.calls, result.events[event_alloc],
+            result.events[event_free], result.events[event_lock], result.events[event_busLock],
+            !safe ? "NOT RT SAFE" : (result.changedChannels > 0 ? "CHANNELS PAST THE SECOND CHANGED" : "ok"));
+    }
+
+    for (AkUInt32 site = 0; site < g_uNumSites; ++site)
+    {
+        PrintSite(g_sites[site]);
+    }
+    if (g_uDroppedSites > 0)
+    {
+        printf("\n%u more events came from sites past the first %u\n", g_uDroppedSites, kMaxSites);
+    }
+
+    printf("\n%s\n", passed ? "pass" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,548 @@
+// Game mix load generator: plays a scripted mix (MixScript.h) through the plug-in on the stand-in host, with one-shots
+// starting and ending in bursts, long dialogue lines, ambience going virtual and back, and RTPC sweeps, the way a game's
+// sound engine would drive it. Everything comes from the seed, so a run can be repeated exactly, and performance work can be
+// judged on the churn of a real mix instead of on a steady state.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O2 -DAK_OPTIMIZED -I"$WWISESDK/include" AutoCompressorScenario.cpp MixScript.cpp ../Common/ParamNames.cpp
+//       ../Common/StandInHost.cpp $(ls ../../SoundEnginePlugin/*.cpp | grep -v AutoCompressorFXShared) -lpthread -o AutoCompressorScenario
+//
+// Usage:
+//   AutoCompressorScenario [--seed N] [--voices X] [--rate X] [--frames N] [--sample-rate Hz] [--csv ticks.csv] mix.txt
+//
+// Mixes/ has a few to start from. --voices scales every class's keep and burst sizes, --rate its spawn rates and how often
+// it bursts. What it reports:
+//   - CPU per tick: Execute and TimeSkip of every voice, and apart from it Init and Term of the voices starting and ending
+//   - sidechain publish latency: from the first instance of a group starting a tick to the group's snapshot showing the tick
+//     closed (AutoCompressorQuery::GetGroup), and the ticks where that didn't happen within the tick
+//   - gain reduction per class, from the energy of every buffer before and after Execute
+//   - a checksum of every output buffer, the same on every run with the same seed, scales and build. Unless a class sets a
+//     CpuBudget: the governor goes by measured time
+
+#include "MixScript.h"
+#include "../Common/StandInHost.h"
+#include "../../SoundEnginePlugin/GainReductionQuery.h"
+#include "../../SoundEnginePlugin/TraceRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const double kVirtualSpellSeconds = 4.0;    // a virtual spell and the audible one after it, on average
+    const double kSilenceMS = 1e-8;             // -80 dBFS, quieter buffers say nothing about the gain
+
+    struct Options
+    {
+        AkUInt32 uSeed = 1;
+        double voiceScale = 1.0;
+        double rateScale = 1.0;
+        AkUInt16 uFrames = 512;
+        AkUInt32 uSampleRate = 48000;
+        const char* pszCsv = nullptr;
+        const char* pszMix = nullptr;
+    };
+
+    void PrintUsage()
+    {
+        fprintf(stderr, "usage: AutoCompressorScenario [--seed N] [--voices X] [--rate X] [--frames N] [--sample-rate Hz] [--csv ticks.csv] mix.txt\n");
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& out_options)
+    {
+        for (int arg = 1; arg < argc; ++arg)
+        {
+            const std::string option = argv[arg];
+            const bool hasValue = arg + 1 < argc;
+            if (option == "--seed" && hasValue)
+            {
+                out_options.uSeed = static_cast<AkUInt32>(strtoul(argv[++arg], nullptr, 10));
+            }
+            else if (option == "--voices" && hasValue)
+            {
+                out_options.voiceScale = strtod(argv[++arg], nullptr);
+            }
+            else if (option == "--rate" && hasValue)
+            {
+                out_options.rateScale = strtod(argv[++arg], nullptr);
+            }
+            else if (option == "--frames" && hasValue)
+            {
+                out_options.uFrames = static_cast<AkUInt16>(atoi(argv[++arg]));
+            }
+            else if (option == "--sample-rate" && hasValue)
+            {
+                out_options.uSampleRate = static_cast<AkUInt32>(atoi(argv[++arg]));
+            }
+            else if (option == "--csv" && hasValue)
+            {
+                out_options.pszCsv = argv[++arg];
+            }
+            else if (option[0] != '-' && out_options.pszMix == nullptr)
+            {
+                out_options.pszMix = argv[arg];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return out_options.pszMix != nullptr && out_options.uFrames > 0 && out_options.uSampleRate > 0
+            && out_options.voiceScale >= 0.0 && out_options.rateScale >= 0.0;
+    }
+
+    struct Voice
+    {
+        StandInVoice host;
+        size_t voiceClass = 0;
+        AkUInt64 uFramesLeft = 0;
+        AkReal32 gain = 0.0f;
+        std::mt19937 rng;
+        double phase = 0.0;                     // of the tone, or of the syllable for speech
+        double increment = 0.0;                 // per frame
+        AkUInt64 uPhraseFramesLeft = 0;         // speech: of the phrase or of the pause after it
+        bool talking = true;
+        bool isVirtual = false;
+        AkUInt64 uSpellFramesLeft = 0;          // until the voice goes virtual or comes back
+    };
+
+    struct ClassStats
+    {
+        AkUInt32 uStarted = 0;
+        AkUInt32 uPlaying = 0;
+        AkUInt32 uPeak = 0;
+        double nextBurst = 0.0;                 // seconds
+        std::vector<AkReal32> gainReductionDB;  // one per Execute of a buffer that wasn't silent
+    };
+
+    // Pending ticks of a group, from its first instance's call in a tick to its snapshot showing the tick closed
+    struct GroupStats
+    {
+        std::deque<std::chrono::steady_clock::time_point> pending;
+        AkUInt32 uLastTick = 0;
+        AkUInt32 uTicks = 0;                    // ticks where the group had an instance running
+        AkUInt32 uLate = 0;                     // of those, the ones not closed by the end of the tick
+        AkUInt32 uExtra = 0;                    // closes more than one per tick
+        std::vector<AkUInt32> latencyNs;
+    };
+
+    double Percentile(std::vector<AkUInt32> io_values, double in_fraction)
+    {
+        if (io_values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(io_values.begin(), io_values.end());
+        return io_values[std::min(io_values.size() - 1, static_cast<size_t>(in_fraction * io_values.size()))];
+    }
+
+    double Percentile(std::vector<AkReal32> io_values, double in_fraction)
+    {
+        if (io_values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(io_values.begin(), io_values.end());
+        return io_values[std::min(io_values.size() - 1, static_cast<size_t>(in_fraction * io_values.size()))];
+    }
+
+    AkUInt64 DrawSpell(Voice& io_voice, double in_fraction, AkUInt32 in_uSampleRate)
+    {
+        const double meanSeconds = kVirtualSpellSeconds * (io_voice.isVirtual ? in_fraction : 1.0 - in_fraction);
+        std::exponential_distribution<double> spell(1.0 / std::max(meanSeconds, 1e-3));
+        return static_cast<AkUInt64>(spell(io_voice.rng) * in_uSampleRate) + 1;
+    }
+
+    void SetParam(StandInVoice& io_voice, const ParamName& in_param, double in_value)
+    {
+        if (in_param.isInt)
+        {
+            io_voice.SetParam(in_param.id, static_cast<AkInt32>(std::lround(in_value)));
+        }
+        else
+        {
+            io_voice.SetParam(in_param.id, static_cast<AkReal32>(in_value));
+        }
+    }
+
+    std::unique_ptr<Voice> StartVoice(const MixScript& in_mix, size_t in_class, StandInAllocator& io_allocator, std::mt19937& io_rng,
+        const Options& in_options, AkUInt64 in_uFramesToEnd)
+    {
+        const MixScript::VoiceClass& voiceClass = in_mix.classes[in_class];
+        std::unique_ptr<Voice> voice(new Voice());
+        voice->voiceClass = in_class;
+        voice->rng.seed(io_rng());
+
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        auto pick = [&](const MixScript::Range& in_range) { return in_range.min + ((in_range.max - in_range.min) * unit(voice->rng)); };
+        voice->uFramesLeft = (voiceClass.length.min < 0.0) ? in_uFramesToEnd
+            : std::min(in_uFramesToEnd, static_cast<AkUInt64>(pick(voiceClass.length) * in_options.uSampleRate) + 1);
+        voice->gain = static_cast<AkReal32>(pow(10.0, pick(voiceClass.levelDB) / 20.0));
+        if (voiceClass.signal == MixScript::signal_tone)
+        {
+            voice->increment = 2.0 * M_PI * (80.0 + (920.0 * unit(voice->rng))) / in_options.uSampleRate;
+        }
+        else if (voiceClass.signal == MixScript::signal_speech)
+        {
+            voice->increment = M_PI * (4.0 + (2.0 * unit(voice->rng))) / in_options.uSampleRate;     // 4 to 6 syllables a second
+            voice->uPhraseFramesLeft = static_cast<AkUInt64>((1.0 + (2.0 * unit(voice->rng))) * in_options.uSampleRate);
+        }
+        if (voiceClass.virtualFraction > 0.0)
+        {
+            voice->isVirtual = unit(voice->rng) < voiceClass.virtualFraction;
+            voice->uSpellFramesLeft = DrawSpell(*voice, voiceClass.virtualFraction, in_options.uSampleRate);
+        }
+
+        // the group has to be known before Init to register on the right bus, the rest can follow
+        if (!voice->host.Init(io_allocator, in_options.uSampleRate, 2, in_options.uFrames, voiceClass.group))
+        {
+            return nullptr;
+        }
+        for (const MixScript::ParamValue& param : voiceClass.params)
+        {
+            SetParam(voice->host, *param.param, param.value);
+        }
+        return voice;
+    }
+
+    void FillSignal(Voice& io_voice, MixScript::Signal in_signal, AkUInt16 in_uFrames)
+    {
+        AkReal32* pLeft = io_voice.host.GetChannel(0);
+        AkReal32* pRight = io_voice.host.GetChannel(1);
+        std::uniform_real_distribution<AkReal32> noise(-1.0f, 1.0f);
+        for (AkUInt16 frame = 0; frame < in_uFrames; ++frame)
+        {
+            AkReal32 sample = 0.0f;
+            if (in_signal == MixScript::signal_tone)
+            {
+                sample = static_cast<AkReal32>(sin(io_voice.phase));
+                io_voice.phase = fmod(io_voice.phase + io_voice.increment, 2.0 * M_PI);
+            }
+            else if (in_signal == MixScript::signal_speech)
+            {
+                // syllables of noise, in phrases of 1 to 3 seconds with pauses of 0.3 to 1 second between them
+                if (io_voice.uPhraseFramesLeft == 0)
+                {
+                    io_voice.talking = !io_voice.talking;
+                    std::uniform_real_distribution<double> seconds(io_voice.talking ? 1.0 : 0.3, io_voice.talking ? 3.0 : 1.0);
+                    io_voice.uPhraseFramesLeft = static_cast<AkUInt64>(seconds(io_voice.rng) / io_voice.increment * M_PI * 5.0) + 1;
+                }
+                io_voice.uPhraseFramesLeft--;
+                const AkReal32 syllable = static_cast<AkReal32>(sin(io_voice.phase));
+                io_voice.phase = fmod(io_voice.phase + io_voice.increment, M_PI);
+                sample = io_voice.talking ? noise(io_voice.rng) * syllable * syllable : 0.0f;
+            }
+            else
+            {
+                sample = noise(io_voice.rng);
+            }
+            pLeft[frame] = sample * io_voice.gain;
+            pRight[frame] = sample * io_voice.gain * 0.8f;
+        }
+    }
+
+    AkReal32 MeanSquare(const StandInVoice& in_voice, AkUInt16 in_uFrames)
+    {
+        StandInVoice& voice = const_cast<StandInVoice&>(in_voice);
+        double sum = 0.0;
+        for (AkUInt16 channel = 0; channel < 2; ++channel)
+        {
+            const AkReal32* pFrames = voice.GetChannel(channel);
+            for (AkUInt16 frame = 0; frame < in_uFrames; ++frame)
+            {
+                sum += pFrames[frame] * pFrames[frame];
+            }
+        }
+        return static_cast<AkReal32>(sum / (2.0 * std::max<AkUInt16>(in_uFrames, 1)));
+    }
+
+    // FNV-1a over the bits of the samples
+    void Checksum(AkUInt64& io_uHash, const StandInVoice& in_voice, AkUInt16 in_uFrames)
+    {
+        StandInVoice& voice = const_cast<StandInVoice&>(in_voice);
+        for (AkUInt16 channel = 0; channel < 2; ++channel)
+        {
+            const AkReal32* pFrames = voice.GetChannel(channel);
+            for (AkUInt16 frame = 0; frame < in_uFrames; ++frame)
+            {
+                AkUInt32 uBits;
+                memcpy(&uBits, &pFrames[frame], sizeof(uBits));
+                io_uHash = (io_uHash ^ uBits) * 1099511628211ull;
+            }
+        }
+    }
+
+    AkUInt32 ElapsedNs(std::chrono::steady_clock::time_point in_start, std::chrono::steady_clock::time_point in_end)
+    {
+        return static_cast<AkUInt32>(std::chrono::duration_cast<std::chrono::nanoseconds>(in_end - in_start).count());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+    TraceRecorder::get().startFromEnvironment();
+
+    MixScript mix;
+    std::string error;
+    if (!mix.Load(options.pszMix, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    FILE* csv = nullptr;
+    if (options.pszCsv != nullptr)
+    {
+        csv = fopen(options.pszCsv, "w");
+        if (csv == nullptr)
+        {
+            fprintf(stderr, "%s: can't write\n", options.pszCsv);
+            return 1;
+        }
+        fprintf(csv, "tick,seconds,voices,virtual,started,ended,execute_us,lifecycle_us\n");
+    }
+
+    const AkUInt64 uTotalFrames = static_cast<AkUInt64>(mix.duration * options.uSampleRate);
+    const double tickSeconds = static_cast<double>(options.uFrames) / options.uSampleRate;
+    const AkUInt32 uTicks = static_cast<AkUInt32>((uTotalFrames + options.uFrames - 1) / options.uFrames);
+
+    StandInAllocator allocator;
+    std::mt19937 rng(options.uSeed);
+    std::vector<ClassStats> classStats(mix.classes.size());
+    std::vector<GroupStats> groupStats(GlobalManager::kNumGroups);
+    std::vector<std::unique_ptr<Voice>> voices;
+    std::vector<AkUInt32> executeNs, lifecycleNs;
+    executeNs.reserve(uTicks);
+    lifecycleNs.reserve(uTicks);
+    AkUInt32 uPeakVoices = 0;
+    double voiceTicks = 0.0;
+    AkUInt64 uChecksum = 14695981039346656037ull;
+    static AutoCompressorQuery::GroupInfo info;
+    for (AkInt32 iGroup = 0; iGroup < GlobalManager::kNumGroups; ++iGroup)
+    {
+        groupStats[iGroup].uLastTick = AutoCompressorQuery::GetGroup(iGroup, info) ? info.tick : 0;
+    }
+
+    for (AkUInt32 uTick = 0; uTick < uTicks; ++uTick)
+    {
+        const double time = uTick * tickSeconds;
+        const AkUInt64 uFramesToEnd = uTotalFrames - (static_cast<AkUInt64>(uTick) * options.uFrames);
+        AkUInt32 uTickLifecycleNs = 0;
+        AkUInt32 uStarted = 0;
+
+        // voices starting this tick: the ones kept playing, the one-shots and the bursts, in the order of the script
+        for (size_t index = 0; index < mix.classes.size(); ++index)
+        {
+            const MixScript::VoiceClass& voiceClass = mix.classes[index];
+            ClassStats& stats = classStats[index];
+            AkUInt32 uCount = 0;
+            const AkUInt32 uKeep = static_cast<AkUInt32>(std::lround(voiceClass.keep * options.voiceScale));
+            uCount += (stats.uPlaying < uKeep) ? uKeep - stats.uPlaying : 0;
+            if (voiceClass.spawnRate > 0.0 && options.rateScale > 0.0)
+            {
+                std::poisson_distribution<AkUInt32> spawns(voiceClass.spawnRate * options.rateScale * tickSeconds);
+                uCount += spawns(rng);
+            }
+            if (voiceClass.burstVoices > 0 && options.rateScale > 0.0 && time >= stats.nextBurst)
+            {
+                std::uniform_real_distribution<double> jitter(0.5, 1.5);
+                stats.nextBurst = time + (voiceClass.burstPeriod / options.rateScale * jitter(rng));
+                uCount += (uTick > 0) ? static_cast<AkUInt32>(std::lround(voiceClass.burstVoices * options.voiceScale)) : 0;
+            }
+
+            for (AkUInt32 uVoice = 0; uVoice < uCount; ++uVoice)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                std::unique_ptr<Voice> voice = StartVoice(mix, index, allocator, rng, options, uFramesToEnd);
+                uTickLifecycleNs += ElapsedNs(start, std::chrono::steady_clock::now());
+                if (voice == nullptr)
+                {
+                    fprintf(stderr, "the plug-in failed to initialize\n");
+                    return 1;
+                }
+                voices.push_back(std::move(voice));
+                stats.uStarted++;
+                stats.uPlaying++;
+                stats.uPeak = std::max(stats.uPeak, stats.uPlaying);
+                uStarted++;
+            }
+        }
+
+        // RTPC sweeps, a triangle from 'from' to 'to' and back once per period
+        for (const MixScript::Sweep& sweep : mix.sweeps)
+        {
+            const double position = fmod(time / sweep.period, 1.0);
+            const double value = sweep.from + ((sweep.to - sweep.from) * (1.0 - fabs((2.0 * position) - 1.0)));
+            for (std::unique_ptr<Voice>& voice : voices)
+            {
+                if (voice->voiceClass == sweep.voiceClass)
+                {
+                    SetParam(voice->host, *sweep.param, value);
+                }
+            }
+        }
+
+        // every voice's buffer, the groups' snapshots polled after each call to see when their tick closed
+        AkUInt32 uTickExecuteNs = 0;
+        AkUInt32 uVirtual = 0;
+        std::vector<bool> groupRan(GlobalManager::kNumGroups, false);
+        std::vector<AkUInt32> groupCloses(GlobalManager::kNumGroups, 0);
+        for (std::unique_ptr<Voice>& voice : voices)
+        {
+            const MixScript::VoiceClass& voiceClass = mix.classes[voice->voiceClass];
+            const AkInt32 iGroup = std::clamp(voiceClass.group, 0, GlobalManager::kNumGroups - 1);
+            GroupStats& group = groupStats[iGroup];
+            const AkUInt16 uValidFrames = static_cast<AkUInt16>(std::min<AkUInt64>(options.uFrames, voice->uFramesLeft));
+
+            const auto start = std::chrono::steady_clock::now();
+            if (!groupRan[iGroup])
+            {
+                groupRan[iGroup] = true;
+                group.uTicks++;
+                group.pending.push_back(start);
+            }
+
+            if (voice->isVirtual)
+            {
+                uVirtual++;
+                const auto callStart = std::chrono::steady_clock::now();
+                voice->host.TimeSkip(uValidFrames);
+                uTickExecuteNs += ElapsedNs(callStart, std::chrono::steady_clock::now());
+            }
+            else
+            {
+                FillSignal(*voice, voiceClass.signal, uValidFrames);
+                const AkReal32 inMS = MeanSquare(voice->host, uValidFrames);
+                const auto callStart = std::chrono::steady_clock::now();
+                voice->host.Execute(uValidFrames);
+                uTickExecuteNs += ElapsedNs(callStart, std::chrono::steady_clock::now());
+                const AkReal32 outMS = MeanSquare(voice->host, uValidFrames);
+                if (inMS > kSilenceMS)
+                {
+                    classStats[voice->voiceClass].gainReductionDB.push_back(10.0f * log10f(inMS / std::max(outMS, 1e-20f)));
+                }
+                Checksum(uChecksum, voice->host, uValidFrames);
+            }
+
+            if (AutoCompressorQuery::GetGroup(iGroup, info))
+            {
+                const auto now = std::chrono::steady_clock::now();
+                AkUInt32 uClosed = info.tick - group.uLastTick;
+                group.uLastTick = info.tick;
+                groupCloses[iGroup] += uClosed;
+                for (; uClosed > 0 && !group.pending.empty(); --uClosed)
+                {
+                    group.latencyNs.push_back(ElapsedNs(group.pending.front(), now));
+                    group.pending.pop_front();
+                }
+            }
+
+            voice->uFramesLeft -= uValidFrames;
+            if (voiceClass.virtualFraction > 0.0 && voiceClass.virtualFraction < 1.0)
+            {
+                voice->uSpellFramesLeft -= std::min<AkUInt64>(voice->uSpellFramesLeft, uValidFrames);
+                if (voice->uSpellFramesLeft == 0)
+                {
+                    voice->isVirtual = !voice->isVirtual;
+                    voice->uSpellFramesLeft = DrawSpell(*voice, voiceClass.virtualFraction, options.uSampleRate);
+                }
+            }
+        }
+        for (AkInt32 iGroup = 0; iGroup < GlobalManager::kNumGroups; ++iGroup)
+        {
+            GroupStats& group = groupStats[iGroup];
+            group.uLate += (groupRan[iGroup] && groupCloses[iGroup] == 0) ? 1 : 0;
+            group.uExtra += (groupCloses[iGroup] > 1) ? groupCloses[iGroup] - 1 : 0;
+        }
+
+        // voices that played their last frames end, like a sound that finished
+        AkUInt32 uEnded = 0;
+        for (std::unique_ptr<Voice>& voice : voices)
+        {
+            if (voice->uFramesLeft == 0)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                voice->host.Term();
+                uTickLifecycleNs += ElapsedNs(start, std::chrono::steady_clock::now());
+                classStats[voice->voiceClass].uPlaying--;
+                voice.reset();
+                uEnded++;
+            }
+        }
+        voices.erase(std::remove(voices.begin(), voices.end(), nullptr), voices.end());
+
+        executeNs.push_back(uTickExecuteNs);
+        lifecycleNs.push_back(uTickLifecycleNs);
+        uPeakVoices = std::max(uPeakVoices, static_cast<AkUInt32>(voices.size() + uEnded));
+        voiceTicks += voices.size() + uEnded;
+        if (csv != nullptr)
+        {
+            fprintf(csv, "%u,%.4f,%zu,%u,%u,%u,%.2f,%.2f\n", uTick, time, voices.size() + uEnded, uVirtual, uStarted, uEnded,
+                uTickExecuteNs / 1000.0, uTickLifecycleNs / 1000.0);
+        }
+    }
+    for (std::unique_ptr<Voice>& voice : voices)
+    {
+        voice->host.Term();
+    }
+    if (csv != nullptr)
+    {
+        fclose(csv);
+    }
+
+    const double tickUs = tickSeconds * 1e6;
+    printf("%s, seed %u, voices x%.2f, rate x%.2f: %.1f s at %u Hz in %u frame ticks (%u ticks)\n", options.pszMix, options.uSeed,
+        options.voiceScale, options.rateScale, mix.duration, options.uSampleRate, options.uFrames, uTicks);
+    printf("voices playing: %.1f on average, %u at most\n\n", voiceTicks / std::max<AkUInt32>(uTicks, 1), uPeakVoices);
+
+    printf("%-28s %10s %10s %10s %10s\n", "per tick, us", "p50", "p99", "max", "p99 load");
+    printf("%-28s %10.1f %10.1f %10.1f %9.1f%%\n", "Execute and TimeSkip", Percentile(executeNs, 0.5) / 1000.0, Percentile(executeNs, 0.99) / 1000.0,
+        Percentile(executeNs, 1.0) / 1000.0, Percentile(executeNs, 0.99) / 1000.0 / tickUs * 100.0);
+    printf("%-28s %10.1f %10.1f %10.1f %9.1f%%\n\n", "Init and Term", Percentile(lifecycleNs, 0.5) / 1000.0, Percentile(lifecycleNs, 0.99) / 1000.0,
+        Percentile(lifecycleNs, 1.0) / 1000.0, Percentile(lifecycleNs, 0.99) / 1000.0 / tickUs * 100.0);
+
+    printf("%-28s %10s %10s %10s %10s %10s %10s\n", "sidechain publish, us", "p50", "p99", "max", "ticks", "late", "extra");
+    for (AkInt32 iGroup = 0; iGroup < GlobalManager::kNumGroups; ++iGroup)
+    {
+        const GroupStats& group = groupStats[iGroup];
+        if (group.uTicks == 0)
+        {
+            continue;
+        }
+        printf("group %-22d %10.1f %10.1f %10.1f %10u %10u %10u\n", iGroup, Percentile(group.latencyNs, 0.5) / 1000.0,
+            Percentile(group.latencyNs, 0.99) / 1000.0, Percentile(group.latencyNs, 1.0) / 1000.0, group.uTicks, group.uLate, group.uExtra);
+    }
+
+    printf("\n%-28s %10s %10s %10s %10s %10s %10s\n", "gain reduction, dB", "started", "peak", "mean", "p95", "max", "ducked");
+    for (size_t index = 0; index < mix.classes.size(); ++index)
+    {
+        const ClassStats& stats = classStats[index];
+        double sum = 0.0;
+        size_t uDucked = 0;
+        for (AkReal32 gainReductionDB : stats.gainReductionDB)
+        {
+            sum += gainReductionDB;
+            uDucked += (gainReductionDB > 1.0f) ? 1 : 0;
+        }
+        const double buffers = static_cast<double>(std::max<size_t>(stats.gainReductionDB.size(), 1));
+        printf("%-28s %10u %10u %10.2f %10.2f %10.2f %9.1f%%\n", mix.classes[index].name.c_str(), stats.uStarted, stats.uPeak, sum / buffers,
+            Percentile(stats.gainReductionDB, 0.95), Percentile(stats.gainReductionDB, 1.0), 100.0 * uDucked / buffers);
+    }
+
+    printf("\noutput checksum %016llx\n", static_cast<unsigned long long>(uChecksum));
+    return 0;
+}
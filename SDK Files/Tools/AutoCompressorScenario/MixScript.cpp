@@ -0,0 +1,183 @@
+#include "MixScript.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    // "a" or "a..b", the bounds in any order
+    bool ParseRange(const std::string& in_text, MixScript::Range& out_range)
+    {
+        const size_t dots = in_text.find("..");
+        const std::string first = in_text.substr(0, dots);
+        const std::string second = (dots == std::string::npos) ? first : in_text.substr(dots + 2);
+        char* end = nullptr;
+        const double a = strtod(first.c_str(), &end);
+        if (first.empty() || *end != '\0')
+        {
+            return false;
+        }
+        const double b = strtod(second.c_str(), &end);
+        if (second.empty() || *end != '\0')
+        {
+            return false;
+        }
+        out_range = { std::min(a, b), std::max(a, b) };
+        return true;
+    }
+
+    bool ParseNumber(const std::string& in_text, double& out_value)
+    {
+        char* end = nullptr;
+        out_value = strtod(in_text.c_str(), &end);
+        return !in_text.empty() && *end == '\0';
+    }
+
+    bool ParseClassKey(const std::string& in_key, const std::string& in_value, MixScript::VoiceClass& io_class, std::string& out_error)
+    {
+        double number = 0.0;
+        if (in_key == "group" && ParseNumber(in_value, number))
+        {
+            io_class.group = static_cast<AkInt32>(number);
+        }
+        else if (in_key == "keep" && ParseNumber(in_value, number) && number >= 0.0)
+        {
+            io_class.keep = static_cast<AkUInt32>(number);
+        }
+        else if (in_key == "spawn" && ParseNumber(in_value, number) && number >= 0.0)
+        {
+            io_class.spawnRate = number;
+        }
+        else if (in_key == "burst")
+        {
+            const size_t slash = in_value.find('/');
+            double period = 0.0;
+            if (slash == std::string::npos || !ParseNumber(in_value.substr(0, slash), number) || !ParseNumber(in_value.substr(slash + 1), period)
+                || number < 0.0 || period <= 0.0)
+            {
+                out_error = "burst takes voices/seconds";
+                return false;
+            }
+            io_class.burstVoices = static_cast<AkUInt32>(number);
+            io_class.burstPeriod = period;
+        }
+        else if (in_key == "length" || in_key == "level")
+        {
+            MixScript::Range& range = (in_key == "length") ? io_class.length : io_class.levelDB;
+            if (!ParseRange(in_value, range) || (in_key == "length" && range.min <= 0.0))
+            {
+                out_error = in_key + " takes a number or a range a..b";
+                return false;
+            }
+        }
+        else if (in_key == "signal" && (in_value == "noise" || in_value == "tone" || in_value == "speech"))
+        {
+            io_class.signal = (in_value == "tone") ? MixScript::signal_tone : (in_value == "speech") ? MixScript::signal_speech : MixScript::signal_noise;
+        }
+        else if (in_key == "virtual" && ParseNumber(in_value, number) && number >= 0.0 && number <= 1.0)
+        {
+            io_class.virtualFraction = number;
+        }
+        else if (const ParamName* param = FindParam(in_key))
+        {
+            if (!ParseNumber(in_value, number))
+            {
+                out_error = in_key + " takes a number";
+                return false;
+            }
+            io_class.params.push_back({ param, number });
+        }
+        else
+        {
+            out_error = "bad class key " + in_key + "=" + in_value;
+            return false;
+        }
+        return true;
+    }
+}
+
+bool MixScript::Load(const std::string& in_path, std::string& out_error)
+{
+    std::ifstream file(in_path);
+    if (!file)
+    {
+        out_error = in_path + ": can't be opened";
+        return false;
+    }
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber)
+    {
+        const std::string where = in_path + ":" + std::to_string(lineNumber) + ": ";
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string statement;
+        if (!(fields >> statement))
+        {
+            continue;
+        }
+
+        if (statement == "duration")
+        {
+            if (!(fields >> duration) || duration <= 0.0)
+            {
+                out_error = where + "expected duration <seconds>";
+                return false;
+            }
+        }
+        else if (statement == "class")
+        {
+            VoiceClass voiceClass;
+            if (!(fields >> voiceClass.name))
+            {
+                out_error = where + "expected class <name> <key=value>...";
+                return false;
+            }
+            std::string setting;
+            while (fields >> setting)
+            {
+                const size_t equals = setting.find('=');
+                std::string error = "expected key=value, got " + setting;
+                if (equals == std::string::npos || !ParseClassKey(setting.substr(0, equals), setting.substr(equals + 1), voiceClass, error))
+                {
+                    out_error = where + error;
+                    return false;
+                }
+            }
+            classes.push_back(voiceClass);
+        }
+        else if (statement == "sweep")
+        {
+            std::string className, paramName;
+            Sweep sweep = {};
+            if (!(fields >> className >> paramName >> sweep.from >> sweep.to >> sweep.period) || sweep.period <= 0.0)
+            {
+                out_error = where + "expected sweep <class> <parameter> <from> <to> <seconds>";
+                return false;
+            }
+            auto voiceClass = std::find_if(classes.begin(), classes.end(), [&](const VoiceClass& in_class) { return in_class.name == className; });
+            sweep.param = FindParam(paramName);
+            if (voiceClass == classes.end() || sweep.param == nullptr)
+            {
+                out_error = where + ((sweep.param == nullptr) ? "unknown parameter " + paramName : "no class " + className + " above");
+                return false;
+            }
+            sweep.voiceClass = static_cast<size_t>(voiceClass - classes.begin());
+            sweeps.push_back(sweep);
+        }
+        else
+        {
+            out_error = where + "unknown statement " + statement;
+            return false;
+        }
+    }
+
+    if (classes.empty())
+    {
+        out_error = in_path + ": no class of voices";
+        return false;
+    }
+    return true;
+}
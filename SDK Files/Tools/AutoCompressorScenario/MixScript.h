@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../Common/ParamNames.h"
+
+#include <string>
+#include <vector>
+
+// A game mix to load the plug-in with, read from a text file with one statement per line:
+//
+//   duration 120
+//   # class     name      how many and how often              what each voice is
+//   class       music     group=0 keep=1                      signal=tone level=-14 Priority=2
+//   class       gunshot   group=0 spawn=4 burst=24/10         length=0.2..1.5 level=-20..-6 Priority=6
+//   class       dialogue  group=0 spawn=0.15                  length=2..6 signal=speech level=-12 Priority=10
+//   class       ambience  group=1 keep=40 virtual=0.6         length=5..30 level=-34..-22 Priority=1
+//   sweep       music     Threshold -30 -18 20
+//
+// class keys:
+//   group     the sidechain group of its voices, 0 by default
+//   keep      voices that are always playing, a new one starts as soon as one ends
+//   spawn     one-shots per second, started at random times
+//   burst     N/S: N voices at once every S seconds, give or take half of S
+//   length    seconds each voice plays, a..b picks one per voice. The whole scenario by default
+//   level     dBFS of the signal, a..b picks one per voice. -12 by default
+//   signal    noise, tone or speech (noise in syllables and phrases). noise by default
+//   virtual   fraction of the time a voice spends virtual, where the sound engine calls TimeSkip instead of Execute
+//   other keys are parameters by their AutoCompressor.xml name, set on every voice of the class as it starts
+//
+// sweep <class> <parameter> <from> <to> <seconds> moves the parameter of every playing voice of the class back and forth
+// between from and to, once per period, as an RTPC would.
+
+class MixScript
+{
+public:
+    enum Signal
+    {
+        signal_noise = 0,
+        signal_tone,
+        signal_speech
+    };
+
+    struct Range
+    {
+        double min;
+        double max;
+    };
+
+    struct ParamValue
+    {
+        const ParamName* param;
+        double value;
+    };
+
+    struct VoiceClass
+    {
+        std::string name;
+        AkInt32 group = 0;
+        AkUInt32 keep = 0;
+        double spawnRate = 0.0;             // per second
+        AkUInt32 burstVoices = 0;
+        double burstPeriod = 0.0;           // seconds
+        Range length = { -1.0, -1.0 };      // negative for the whole scenario
+        Range levelDB = { -12.0, -12.0 };
+        Signal signal = signal_noise;
+        double virtualFraction = 0.0;
+        std::vector<ParamValue> params;
+    };
+
+    struct Sweep
+    {
+        size_t voiceClass;                  // index in classes
+        const ParamName* param;
+        double from;
+        double to;
+        double period;                      // seconds
+    };
+
+    bool Load(const std::string& in_path, std::string& out_error);
+
+    double duration = 60.0;                 // seconds
+    std::vector<VoiceClass> classes;
+    std::vector<Sweep> sweeps;
+};
@@ -0,0 +1,277 @@
+// Timeline harness: runs voices on several threads at once, the way the sound engine processes busses in parallel, with the
+// plug-in's timeline markers compiled in (Timeline.h), and writes what every thread did as Chrome trace-event JSON. Open it in
+// chrome://tracing or ui.perfetto.dev: every Execute, the instance that closed each group's tick and what the close cost,
+// and every wait on a bus's mutex are on the track of the thread they happened on.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O2 -DAK_OPTIMIZED -DAUTOCOMPRESSOR_TIMELINE -I"$WWISESDK/include" AutoCompressorTimeline.cpp
+//       ../Common/StandInHost.cpp $(ls ../../SoundEnginePlugin/*.cpp | grep -v AutoCompressorFXShared) -lpthread -o AutoCompressorTimeline
+//
+// Usage:
+//   AutoCompressorTimeline [--threads N] [--voices N] [--groups N] [--bands N] [--ticks N] [--frames N] [--batch] out.json
+//
+// Voices are dealt to the groups and to the threads in turn, so every group has instances on every thread. Every tick, each
+// thread runs its voices (one AutoCompressorFX::ExecuteBatch with --batch) and waits for the others before the next one, like
+// the sound engine's audio frame. A summary of the markers' durations is printed as well.
+
+#include "../Common/StandInHost.h"
+#include "../../SoundEnginePlugin/Timeline.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(AUTOCOMPRESSOR_TIMELINE)
+#error "build with -DAUTOCOMPRESSOR_TIMELINE, the plug-in's timeline markers are compiled out otherwise"
+#endif
+
+namespace
+{
+    const AkUInt32 kSampleRate = 48000;
+
+    struct Options
+    {
+        AkUInt32 uThreads = 4;
+        AkUInt32 uVoices = 32;
+        AkInt32 iGroups = 2;
+        AkInt32 iBands = 1;
+        AkUInt32 uTicks = 500;
+        AkUInt16 uFrames = 512;
+        bool bBatch = false;
+        const char* pszOutput = nullptr;
+    };
+
+    void PrintUsage()
+    {
+        fprintf(stderr, "usage: AutoCompressorTimeline [--threads N] [--voices N] [--groups N] [--bands N] [--ticks N] [--frames N] [--batch] out.json\n");
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& out_options)
+    {
+        for (int arg = 1; arg < argc; ++arg)
+        {
+            const std::string option = argv[arg];
+            const bool hasValue = arg + 1 < argc;
+            if (option == "--threads" && hasValue)
+            {
+                out_options.uThreads = static_cast<AkUInt32>(atoi(argv[++arg]));
+            }
+            else if (option == "--voices" && hasValue)
+            {
+                out_options.uVoices = static_cast<AkUInt32>(atoi(argv[++arg]));
+            }
+            else if (option == "--groups" && hasValue)
+            {
+                out_options.iGroups = atoi(argv[++arg]);
+            }
+            else if (option == "--bands" && hasValue)
+            {
+                out_options.iBands = atoi(argv[++arg]);
+            }
+            else if (option == "--ticks" && hasValue)
+            {
+                out_options.uTicks = static_cast<AkUInt32>(atoi(argv[++arg]));
+            }
+            else if (option == "--frames" && hasValue)
+            {
+                out_options.uFrames = static_cast<AkUInt16>(atoi(argv[++arg]));
+            }
+            else if (option == "--batch")
+            {
+                out_options.bBatch = true;
+            }
+            else if (option[0] != '-' && out_options.pszOutput == nullptr)
+            {
+                out_options.pszOutput = argv[arg];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return out_options.pszOutput != nullptr && out_options.uThreads > 0 && out_options.uVoices > 0 && out_options.uFrames > 0
+            && out_options.iGroups > 0 && out_options.iGroups <= GlobalManager::kNumGroups;
+    }
+
+    // The end of the audio frame: nobody starts the next tick before every thread is done with this one
+    class TickBarrier
+    {
+    public:
+        explicit TickBarrier(AkUInt32 in_uThreads) : m_uThreads(in_uThreads) {}
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const AkUInt32 uGeneration = m_uGeneration;
+            if (++m_uArrived == m_uThreads)
+            {
+                m_uArrived = 0;
+                m_uGeneration++;
+                m_condition.notify_all();
+                return;
+            }
+            m_condition.wait(lock, [&]() { return m_uGeneration != uGeneration; });
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        AkUInt32 m_uThreads;
+        AkUInt32 m_uArrived = 0;
+        AkUInt32 m_uGeneration = 0;
+    };
+
+    // Noise bursts, each voice at its own level and phase so the group's ducking keeps moving
+    void FillSignal(AkUInt32& io_uSeed, AkReal32* out_pFrames, AkUInt16 in_uFrames, AkUInt32 in_uTick, AkUInt32 in_uVoice)
+    {
+        const AkReal32 level = ((in_uTick + in_uVoice) % 16 < 8) ? 0.5f : 0.02f;
+        const AkReal32 voiceGain = 1.0f / static_cast<AkReal32>(1 + (in_uVoice % 4));
+        for (AkUInt16 frame = 0; frame < in_uFrames; ++frame)
+        {
+            io_uSeed = (io_uSeed * 1664525u) + 1013904223u;
+            out_pFrames[frame] = level * voiceGain * ((static_cast<AkReal32>(io_uSeed >> 8) / 8388608.0f) - 1.0f);
+        }
+    }
+
+    struct Durations
+    {
+        std::vector<AkUInt32> ns;
+
+        double PercentileUs(double in_fraction)
+        {
+            std::sort(ns.begin(), ns.end());
+            const size_t index = std::min(ns.size() - 1, static_cast<size_t>(in_fraction * ns.size()));
+            return ns[index] / 1000.0;
+        }
+    };
+
+    void PrintSummary(AkUInt32 in_uThreads)
+    {
+        std::map<std::string, Durations> byName;
+        std::vector<AkUInt32> closesPerThread(in_uThreads, 0);
+        Timeline::get().forEach([&](AkUInt32 in_uThread, const TimelineEvent& in_event)
+        {
+            byName[in_event.name].ns.push_back(in_event.durationNs);
+            if (strcmp(in_event.name, "close tick") == 0 && in_uThread < in_uThreads)
+            {
+                closesPerThread[in_uThread]++;
+            }
+        });
+
+        printf("%-34s %9s %10s %10s %10s %12s\n", "marker", "count", "p50 us", "p99 us", "max us", "total ms");
+        for (auto& entry : byName)
+        {
+            Durations& durations = entry.second;
+            double totalMs = 0.0;
+            for (AkUInt32 ns : durations.ns)
+            {
+                totalMs += ns / 1e6;
+            }
+            printf("%-34s %9zu %10.2f %10.2f %10.2f %12.3f\n", entry.first.c_str(), durations.ns.size(), durations.PercentileUs(0.5),
+                durations.PercentileUs(0.99), durations.PercentileUs(1.0), totalMs);
+        }
+
+        printf("\ntick closes per thread:");
+        for (AkUInt32 uCloses : closesPerThread)
+        {
+            printf(" %u", uCloses);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    StandInAllocator allocator;
+    std::unique_ptr<StandInVoice[]> voices(new StandInVoice[options.uVoices]);
+    for (AkUInt32 uVoice = 0; uVoice < options.uVoices; ++uVoice)
+    {
+        StandInVoice& voice = voices[uVoice];
+        if (!voice.Init(allocator, kSampleRate, 2, options.uFrames, static_cast<AkInt32>(uVoice % options.iGroups)))
+        {
+            fprintf(stderr, "voice %u: the plug-in failed to initialize\n", uVoice);
+            return 1;
+        }
+        voice.SetParam(PARAM_THRESHOLD_ID, -30.0f);
+        voice.SetParam(PARAM_RATIO_ID, 4.0f);
+        voice.SetParam(PARAM_ATTACK_ID, 0.01f);
+        voice.SetParam(PARAM_RELEASE_ID, 0.2f);
+        voice.SetParam(PARAM_PRIORITY_ID, static_cast<AkReal32>(1 + (uVoice % 5)));
+        voice.SetParam(PARAM_BANDS_ID, options.iBands);
+    }
+
+    // about a dozen markers per voice and tick, and as many again for the tick closes. One more buffer for the analysis worker, if something starts it
+    const AkUInt32 uVoicesPerThread = (options.uVoices + options.uThreads - 1) / options.uThreads;
+    Timeline::get().start(options.uThreads + 1, options.uTicks * (uVoicesPerThread + 1) * 12 + (options.uTicks * options.iGroups * 12));
+    TickBarrier barrier(options.uThreads);
+    std::vector<std::thread> threads;
+    for (AkUInt32 uThread = 0; uThread < options.uThreads; ++uThread)
+    {
+        threads.emplace_back([&, uThread]()
+        {
+            std::vector<AkUInt32> ownVoices;
+            std::vector<AutoCompressorFX*> plugins;
+            std::vector<AkAudioBuffer*> buffers;
+            for (AkUInt32 uVoice = uThread; uVoice < options.uVoices; uVoice += options.uThreads)
+            {
+                ownVoices.push_back(uVoice);
+                plugins.push_back(voices[uVoice].Plugin());
+                buffers.push_back(voices[uVoice].Buffer());
+            }
+
+            AkUInt32 uSeed = 1234 + uThread;
+            for (AkUInt32 uTick = 0; uTick < options.uTicks; ++uTick)
+            {
+                for (size_t index = 0; index < ownVoices.size(); ++index)
+                {
+                    StandInVoice& voice = voices[ownVoices[index]];
+                    FillSignal(uSeed, voice.GetChannel(0), options.uFrames, uTick, ownVoices[index]);
+                    FillSignal(uSeed, voice.GetChannel(1), options.uFrames, uTick + 5, ownVoices[index]);
+                    buffers[index]->uValidFrames = options.uFrames;
+                    if (!options.bBatch)
+                    {
+                        plugins[index]->Execute(buffers[index]);
+                    }
+                }
+                if (options.bBatch && !ownVoices.empty())
+                {
+                    AutoCompressorFX::ExecuteBatch(plugins.data(), buffers.data(), static_cast<AkUInt16>(ownVoices.size()));
+                }
+                barrier.Wait();
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    Timeline::get().stop();
+
+    PrintSummary(options.uThreads);
+    if (Timeline::get().droppedEvents() > 0)
+    {
+        printf("%u events didn't fit the timeline and were dropped\n", Timeline::get().droppedEvents());
+    }
+    if (!Timeline::get().writeChromeTrace(options.pszOutput))
+    {
+        fprintf(stderr, "%s: can't write\n", options.pszOutput);
+        return 1;
+    }
+    printf("wrote %s\n", options.pszOutput);
+    return 0;
+}
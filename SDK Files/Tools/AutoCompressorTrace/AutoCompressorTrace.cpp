@@ -0,0 +1,300 @@
+// Trace converter: turns the binary DSP traces of the plug-in (TraceRecorder) into CSV, gnuplot scripts and render curves.
+//
+// Record a trace by pointing AUTOCOMPRESSOR_TRACE at a file when running AutoCompressorRender or AutoCompressorScenario:
+//   AUTOCOMPRESSOR_TRACE=session.actrace AutoCompressorRender --stem ...
+// A game records by calling TraceRecorder::get().start(path), or startFromEnvironment(), after initializing the sound
+// engine. The plug-in never starts the recorder on its own, as that creates a thread.
+//
+// Build (Linux, from this directory):
+//   g++ -std=c++17 -O2 -I"$WWISESDK/include" AutoCompressorTrace.cpp -o AutoCompressorTrace
+//
+// Usage:
+//   AutoCompressorTrace csv trace.actrace prefix      writes prefix_bus.csv and prefix_instances.csv
+//   AutoCompressorTrace plot trace.actrace prefix     the CSVs, and prefix.gp to plot them with gnuplot
+//   AutoCompressorTrace curves trace.actrace dir      Priority curves per instance, and the AutoCompressorRender
+//                                                     command that replays them over your own stems
+//
+// Times are rebuilt from the frames and sample rate of each group's ticks, from the first tick of the trace.
+
+#include "../../SoundEnginePlugin/TraceRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    struct Trace
+    {
+        std::vector<TraceRecord> records;
+        std::vector<double> times;              // per record, seconds since the group's first tick
+        AkUInt64 uDropped = 0;
+    };
+
+    void PrintUsage()
+    {
+        fprintf(stderr,
+            "usage: AutoCompressorTrace csv trace.actrace prefix\n"
+            "       AutoCompressorTrace plot trace.actrace prefix\n"
+            "       AutoCompressorTrace curves trace.actrace dir\n");
+    }
+
+    bool Load(const char* in_path, Trace& out_trace)
+    {
+        FILE* file = fopen(in_path, "rb");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "%s: can't open\n", in_path);
+            return false;
+        }
+
+        TraceFileHeader header;
+        if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "ACTRACE", 8) != 0
+            || header.version != 1 || header.recordSize != sizeof(TraceRecord))
+        {
+            fprintf(stderr, "%s: not a version 1 AutoCompressor trace\n", in_path);
+            fclose(file);
+            return false;
+        }
+
+        TraceRecord record;
+        while (fread(&record, sizeof(record), 1, file) == 1)
+        {
+            out_trace.records.push_back(record);
+        }
+        fclose(file);
+
+        // instances of a tick come before the bus record that closes it
+        std::map<AkUInt8, double> groupTime;
+        for (const TraceRecord& rec : out_trace.records)
+        {
+            double& time = groupTime[rec.group];
+            out_trace.times.push_back(time);
+            if (rec.kind == TraceRecord::kind_bus && rec.bus.sampleRate > 0)
+            {
+                time += static_cast<double>(rec.bus.frames) / rec.bus.sampleRate;
+            }
+            else if (rec.kind == TraceRecord::kind_dropped)
+            {
+                out_trace.uDropped += rec.count;
+            }
+        }
+        if (out_trace.uDropped > 0)
+        {
+            fprintf(stderr, "warning: %llu records were dropped while recording, times after the gap are early\n",
+                static_cast<unsigned long long>(out_trace.uDropped));
+        }
+        return true;
+    }
+
+    double ToDB(double in_linear)
+    {
+        return 20.0 * log10(std::max(in_linear, 1e-10));
+    }
+
+    bool WriteCSV(const Trace& in_trace, const std::string& in_prefix)
+    {
+        const std::string busPath = in_prefix + "_bus.csv";
+        const std::string instancesPath = in_prefix + "_instances.csv";
+        FILE* bus = fopen(busPath.c_str(), "w");
+        FILE* instances = fopen(instancesPath.c_str(), "w");
+        if (bus == nullptr || instances == nullptr)
+        {
+            fprintf(stderr, "%s: can't write\n", (bus == nullptr ? busPath : instancesPath).c_str());
+            if (bus != nullptr) fclose(bus);
+            if (instances != nullptr) fclose(instances);
+            return false;
+        }
+
+        fprintf(bus, "time,group,tick,sidechainL_dB,sidechainR_dB,minPriority,maxPriority,instances,culled\n");
+        fprintf(instances, "time,group,tick,slot,priority,percentile,culled,bands");
+        for (AkUInt16 band = 0; band < Crossover::kMaxBands; ++band)
+        {
+            fprintf(instances, ",gr%u_dB,state%u", band, band);
+        }
+        fprintf(instances, "\n");
+
+        for (size_t i = 0; i < in_trace.records.size(); ++i)
+        {
+            const TraceRecord& rec = in_trace.records[i];
+            if (rec.kind == TraceRecord::kind_bus)
+            {
+                fprintf(bus, "%.6f,%u,%u,%.2f,%.2f,%g,%g,%u,%u\n", in_trace.times[i], rec.group, rec.tick,
+                    ToDB(rec.bus.sidechainRMS[0]), ToDB(rec.bus.sidechainRMS[1]), rec.bus.minPriority, rec.bus.maxPriority,
+                    rec.bus.numInstances, rec.bus.numCulled);
+            }
+            else if (rec.kind == TraceRecord::kind_instance)
+            {
+                fprintf(instances, "%.6f,%u,%u,%u,%g,%g,%u,%u", in_trace.times[i], rec.group, rec.tick, rec.slot,
+                    rec.instance.priority, rec.instance.percentile, rec.instance.culled, rec.instance.numBands);
+                for (AkUInt16 band = 0; band < Crossover::kMaxBands; ++band)
+                {
+                    if (band < rec.instance.numBands)
+                    {
+                        fprintf(instances, ",%.2f,%u", rec.instance.gainReductionDB[band], rec.instance.envState[band]);
+                    }
+                    else
+                    {
+                        fprintf(instances, ",,");
+                    }
+                }
+                fprintf(instances, "\n");
+            }
+        }
+        fclose(bus);
+        fclose(instances);
+        printf("wrote %s and %s\n", busPath.c_str(), instancesPath.c_str());
+        return true;
+    }
+
+    bool WritePlot(const Trace& in_trace, const std::string& in_prefix)
+    {
+        std::map<AkUInt8, std::vector<AkUInt16>> slots;
+        for (const TraceRecord& rec : in_trace.records)
+        {
+            std::vector<AkUInt16>& groupSlots = slots[rec.group];
+            if (rec.kind == TraceRecord::kind_instance && std::find(groupSlots.begin(), groupSlots.end(), rec.slot) == groupSlots.end())
+            {
+                groupSlots.push_back(rec.slot);
+            }
+        }
+
+        const std::string path = in_prefix + ".gp";
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "%s: can't write\n", path.c_str());
+            return false;
+        }
+
+        // one page per group: the sidechain on top, the gain reduction of the first band of every slot below
+        fprintf(file, "set datafile separator ','\nset key outside right\nset xlabel 'seconds'\n");
+        for (const auto& group : slots)
+        {
+            if (group.second.empty())
+            {
+                continue;
+            }
+            fprintf(file, "\nset multiplot layout 2,1 title 'group %u'\n", group.first);
+            fprintf(file, "set ylabel 'sidechain dB'\n");
+            fprintf(file, "plot '%s_bus.csv' every ::1 using 1:($2==%u ? $4 : NaN) with lines title 'L', \\\n"
+                "     '' every ::1 using 1:($2==%u ? $5 : NaN) with lines title 'R'\n",
+                in_prefix.c_str(), group.first, group.first);
+            fprintf(file, "set ylabel 'gain reduction dB'\nset yrange [*:*] reverse\n");
+            for (size_t i = 0; i < group.second.size(); ++i)
+            {
+                fprintf(file, "%s'%s_instances.csv' every ::1 using 1:($2==%u && $4==%u ? $9 : NaN) with lines title 'slot %u'%s\n",
+                    (i == 0) ? "plot " : "     ", in_prefix.c_str(), group.first, group.second[i], group.second[i],
+                    (i + 1 < group.second.size()) ? ", \\" : "");
+            }
+            fprintf(file, "set yrange [*:*] noreverse\nunset multiplot\npause mouse close\n");
+        }
+        fclose(file);
+        printf("wrote %s, run: gnuplot %s\n", path.c_str(), path.c_str());
+        return true;
+    }
+
+    bool WriteCurves(const Trace& in_trace, const std::string& in_dir)
+    {
+        // the renderer registers its stems in order, so slot n of a group is the n-th stem on it as long as no voice ended
+        std::map<std::pair<AkUInt8, AkUInt16>, FILE*> curves;
+        std::map<std::pair<AkUInt8, AkUInt16>, AkReal32> lastPriority;
+        for (size_t i = 0; i < in_trace.records.size(); ++i)
+        {
+            const TraceRecord& rec = in_trace.records[i];
+            if (rec.kind != TraceRecord::kind_instance)
+            {
+                continue;
+            }
+
+            const auto key = std::make_pair(rec.group, rec.slot);
+            FILE*& file = curves[key];
+            if (file == nullptr)
+            {
+                char path[512];
+                snprintf(path, sizeof(path), "%s/group%u_slot%u.txt", in_dir.c_str(), rec.group, rec.slot);
+                file = fopen(path, "w");
+                if (file == nullptr)
+                {
+                    fprintf(stderr, "%s: can't write\n", path);
+                    curves.erase(key);
+                    break;
+                }
+                fprintf(file, "# seconds  parameter  value, from an AutoCompressor trace\n");
+            }
+
+            // a step is two breakpoints at the same time, the curves interpolate otherwise
+            auto last = lastPriority.find(key);
+            if (last == lastPriority.end() || last->second != rec.instance.priority)
+            {
+                if (last != lastPriority.end())
+                {
+                    fprintf(file, "%.6f Priority %g\n", in_trace.times[i], last->second);
+                }
+                fprintf(file, "%.6f Priority %g\n", in_trace.times[i], rec.instance.priority);
+                lastPriority[key] = rec.instance.priority;
+            }
+        }
+
+        AkUInt8 currentGroup = 0;
+        std::string command;
+        for (auto& curve : curves)
+        {
+            fclose(curve.second);
+            if (!command.empty() && curve.first.first != currentGroup)
+            {
+                printf("%s\n", command.c_str());
+                command.clear();
+            }
+            if (command.empty())
+            {
+                currentGroup = curve.first.first;
+                command = "AutoCompressorRender --set Group=" + std::to_string(currentGroup);
+            }
+            command += " \\\n    --stem slot" + std::to_string(curve.first.second) + ".wav out" + std::to_string(curve.first.second)
+                + ".wav --curve " + in_dir + "/group" + std::to_string(curve.first.first) + "_slot" + std::to_string(curve.first.second) + ".txt";
+        }
+        if (!command.empty())
+        {
+            printf("%s\n", command.c_str());
+        }
+        return !curves.empty();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    const std::string command = argv[1];
+    Trace trace;
+    if (command != "csv" && command != "plot" && command != "curves")
+    {
+        PrintUsage();
+        return 2;
+    }
+    if (!Load(argv[2], trace))
+    {
+        return 1;
+    }
+
+    bool ok = false;
+    if (command == "curves")
+    {
+        ok = WriteCurves(trace, argv[3]);
+    }
+    else
+    {
+        ok = WriteCSV(trace, argv[3]) && (command == "csv" || WritePlot(trace, argv[3]));
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include "ParamNames.h"
+
+namespace
+{
+    const ParamName kParamNames[] =
+    {
+        { "Threshold", PARAM_THRESHOLD_ID, false },
+        { "Priority", PARAM_PRIORITY_ID, false },
+        { "Ratio", PARAM_RATIO_ID, false },
+        { "Knee", PARAM_KNEE_ID, false },
+        { "Attack", PARAM_ATTACK_ID, false },
+        { "Release", PARAM_RELEASE_ID, false },
+        { "Group", PARAM_GROUP_ID, true },
+        { "Bands", PARAM_BANDS_ID, true },
+        { "Crossover1", PARAM_CROSSOVER1_ID, false },
+        { "Crossover2", PARAM_CROSSOVER1_ID + 1, false },
+        { "Crossover3", PARAM_CROSSOVER1_ID + 2, false },
+        { "Band1Threshold", PARAM_BAND1_THRESHOLD_ID, false },
+        { "Band2Threshold", PARAM_BAND1_THRESHOLD_ID + 1, false },
+        { "Band3Threshold", PARAM_BAND1_THRESHOLD_ID + 2, false },
+        { "Band4Threshold", PARAM_BAND1_THRESHOLD_ID + 3, false },
+        { "Band1Ratio", PARAM_BAND1_RATIO_ID, false },
+        { "Band2Ratio", PARAM_BAND1_RATIO_ID + 1, false },
+        { "Band3Ratio", PARAM_BAND1_RATIO_ID + 2, false },
+        { "Band4Ratio", PARAM_BAND1_RATIO_ID + 3, false },
+        { "AutoThreshold", PARAM_AUTO_THRESHOLD_ID, true },
+        { "AutoPercentile", PARAM_AUTO_PERCENTILE_ID, false },
+        { "AutoHorizon", PARAM_AUTO_HORIZON_ID, false },
+        { "CullBelow", PARAM_CULL_BELOW_ID, false },
+        { "CullKeep", PARAM_CULL_KEEP_ID, true },
+        { "TruePeak", PARAM_TRUE_PEAK_ID, true },
+        { "CpuBudget", PARAM_CPU_BUDGET_ID, false },
+        { "Hold", PARAM_HOLD_ID, false },
+    };
+
+    static_assert(sizeof(kParamNames) / sizeof(kParamNames[0]) == NUM_PARAMS, "every parameter needs a name");
+}
+
+const ParamName* FindParam(const std::string& in_name)
+{
+    for (const ParamName& param : kParamNames)
+    {
+        if (in_name == param.name)
+        {
+            return &param;
+        }
+    }
+    return nullptr;
+}
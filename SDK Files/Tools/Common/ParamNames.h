@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../../SoundEnginePlugin/AutoCompressorFXParams.h"
+
+#include <string>
+
+// Parameter names as they appear in WwisePlugin/AutoCompressor.xml, so tools take the same names as the authoring tool.
+
+struct ParamName
+{
+    const char* name;
+    AkPluginParamID id;
+    bool isInt;             // sent as AkInt32 instead of AkReal32
+};
+
+/// Returns nullptr when in_name isn't a parameter. Names are case-sensitive.
+const ParamName* FindParam(const std::string& in_name);
@@ -0,0 +1,130 @@
+#include "StandInHost.h"
+
+#include <AK/Tools/Common/AkAssert.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+
+// Normally provided by the game, the plug-in library registers itself through these
+DEFINEDUMMYASSERTHOOK;
+DEFINE_PLUGIN_REGISTER_HOOK;
+
+AK::IAkPlugin* CreateAutoCompressorFX(AK::IAkPluginMemAlloc* in_pAllocator);
+AK::IAkPluginParam* CreateAutoCompressorFXParams(AK::IAkPluginMemAlloc* in_pAllocator);
+
+void* StandInAllocator::Malloc(size_t in_uSize, const char* in_pszFile, AkUInt32 in_uLine)
+{
+    return Malign(in_uSize, 16, in_pszFile, in_uLine);
+}
+
+void StandInAllocator::Free(void* in_pMemAddress)
+{
+    free(in_pMemAddress);
+}
+
+void* StandInAllocator::Malign(size_t in_uSize, size_t in_uAlignment, const char*, AkUInt32)
+{
+    void* pMemAddress = nullptr;
+    if (posix_memalign(&pMemAddress, AkMax(in_uAlignment, sizeof(void*)), in_uSize) != 0)
+    {
+        return nullptr;
+    }
+    return pMemAddress;
+}
+
+void* StandInAllocator::Realloc(void* in_pMemAddress, size_t in_uSize, const char* in_pszFile, AkUInt32 in_uLine)
+{
+    return ReallocAligned(in_pMemAddress, in_uSize, 16, in_pszFile, in_uLine);
+}
+
+void* StandInAllocator::ReallocAligned(void* in_pMemAddress, size_t in_uSize, size_t in_uAlignment, const char* in_pszFile, AkUInt32 in_uLine)
+{
+    void* pMemAddress = Malign(in_uSize, in_uAlignment, in_pszFile, in_uLine);
+    if (pMemAddress != nullptr && in_pMemAddress != nullptr)
+    {
+        memcpy(pMemAddress, in_pMemAddress, AkMin(in_uSize, malloc_usable_size(in_pMemAddress)));
+        Free(in_pMemAddress);
+    }
+    return pMemAddress;
+}
+
+StandInVoice::~StandInVoice()
+{
+    Term();
+}
+
+bool StandInVoice::Init(StandInAllocator& in_allocator, AkUInt32 in_uSampleRate, AkUInt16 in_uNumChannels, AkUInt16 in_uMaxFrames, AkInt32 in_iGroup)
+{
+    m_pAllocator = &in_allocator;
+    m_uNumChannels = in_uNumChannels;
+    m_uMaxFrames = in_uMaxFrames;
+
+    m_pParams = static_cast<AutoCompressorFXParams*>(CreateAutoCompressorFXParams(m_pAllocator));
+    m_pPlugin = static_cast<AutoCompressorFX*>(CreateAutoCompressorFX(m_pAllocator));
+    if (m_pParams == nullptr || m_pPlugin == nullptr)
+    {
+        return false;
+    }
+    m_pParams->Init(m_pAllocator, nullptr, 0);
+    SetParam(PARAM_GROUP_ID, in_iGroup);
+
+    AkChannelConfig channelConfig;
+    channelConfig.SetStandard(m_uNumChannels == 1 ? AK_SPEAKER_SETUP_MONO : (m_uNumChannels == 6 ? AK_SPEAKER_SETUP_5POINT1 : AK_SPEAKER_SETUP_STEREO));
+    m_storage.assign(static_cast<size_t>(m_uNumChannels) * m_uMaxFrames, 0.0f);
+    m_buffer.AttachContiguousDeinterleavedData(m_storage.data(), m_uMaxFrames, 0, channelConfig);
+
+    AkAudioFormat format = {};
+    format.uSampleRate = in_uSampleRate;
+    format.channelConfig = channelConfig;
+    GlobalManager::setMaxBufferLength(m_uMaxFrames);     // what the sound engine would tell the instance through its context
+    return m_pPlugin->Init(m_pAllocator, nullptr, m_pParams, format) == AK_Success;
+}
+
+void StandInVoice::Term()
+{
+    if (m_pPlugin != nullptr)
+    {
+        m_pPlugin->Term(m_pAllocator);       // deletes itself
+        m_pPlugin = nullptr;
+    }
+    if (m_pParams != nullptr)
+    {
+        m_pParams->Term(m_pAllocator);
+        m_pParams = nullptr;
+    }
+}
+
+void StandInVoice::SetParam(AkPluginParamID in_paramID, AkReal32 in_fValue)
+{
+    m_pParams->SetParam(in_paramID, &in_fValue, sizeof(in_fValue));
+}
+
+void StandInVoice::SetParam(AkPluginParamID in_paramID, AkInt32 in_iValue)
+{
+    m_pParams->SetParam(in_paramID, &in_iValue, sizeof(in_iValue));
+}
+
+void StandInVoice::Execute(AkUInt16 in_uValidFrames)
+{
+    m_buffer.uValidFrames = in_uValidFrames;
+    m_pPlugin->Execute(&m_buffer);
+}
+
+void StandInVoice::ExecuteBatch(StandInVoice* const* in_ppVoices, const AkUInt16* in_pValidFrames, AkUInt16 in_uNumVoices)
+{
+    std::vector<AutoCompressorFX*> plugins(in_uNumVoices);
+    std::vector<AkAudioBuffer*> buffers(in_uNumVoices);
+    for (AkUInt16 uVoice = 0; uVoice < in_uNumVoices; ++uVoice)
+    {
+        in_ppVoices[uVoice]->m_buffer.uValidFrames = in_pValidFrames[uVoice];
+        plugins[uVoice] = in_ppVoices[uVoice]->m_pPlugin;
+        buffers[uVoice] = &in_ppVoices[uVoice]->m_buffer;
+    }
+    AutoCompressorFX::ExecuteBatch(plugins.data(), buffers.data(), in_uNumVoices);
+}
+
+AKRESULT StandInVoice::TimeSkip(AkUInt32 in_uFrames)
+{
+    return m_pPlugin->TimeSkip(in_uFrames);
+}
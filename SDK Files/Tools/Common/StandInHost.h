@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../../SoundEnginePlugin/AutoCompressorFX.h"
+
+#include <vector>
+
+// Just enough of the sound engine to drive AutoCompressorFX instances outside of Wwise:
+// an allocator, a parameter node per instance and a deinterleaved buffer to run Execute() on.
+// Instances are created without a plugin context, so they skip monitor data and register on the bus by slot only.
+
+class StandInAllocator
+    : public AK::IAkPluginMemAlloc
+{
+public:
+    void* Malloc(size_t in_uSize, const char* in_pszFile, AkUInt32 in_uLine) override;
+    void Free(void* in_pMemAddress) override;
+    void* Malign(size_t in_uSize, size_t in_uAlignment, const char* in_pszFile, AkUInt32 in_uLine) override;
+    void* Realloc(void* in_pMemAddress, size_t in_uSize, const char* in_pszFile, AkUInt32 in_uLine) override;
+    void* ReallocAligned(void* in_pMemAddress, size_t in_uSize, size_t in_uAlignment, const char* in_pszFile, AkUInt32 in_uLine) override;
+};
+
+class StandInVoice
+{
+public:
+    StandInVoice() = default;
+    StandInVoice(const StandInVoice&) = delete;
+    StandInVoice& operator=(const StandInVoice&) = delete;
+    ~StandInVoice();
+
+    /// Creates the parameter node with its defaults and the plug-in, then applies the group before Init so the instance lands on the right bus.
+    /// 1 channel is mono, 6 are 5.1, anything else is stereo.
+    bool Init(StandInAllocator& in_allocator, AkUInt32 in_uSampleRate, AkUInt16 in_uNumChannels, AkUInt16 in_uMaxFrames, AkInt32 in_iGroup = 0);
+    void Term();
+
+    void SetParam(AkPluginParamID in_paramID, AkReal32 in_fValue);
+    void SetParam(AkPluginParamID in_paramID, AkInt32 in_iValue);
+
+    /// Channel storage of the buffer, fill it before Execute and read the result back from it.
+    AkReal32* GetChannel(AkUInt16 in_uChannel) { return m_buffer.GetChannel(in_uChannel); }
+    AkUInt16 NumChannels() const { return m_uNumChannels; }
+    AkUInt16 MaxFrames() const { return m_uMaxFrames; }
+
+    void Execute(AkUInt16 in_uValidFrames);
+
+    /// One tick of several voices through AutoCompressorFX::ExecuteBatch, each with its own number of valid frames.
+    static void ExecuteBatch(StandInVoice* const* in_ppVoices, const AkUInt16* in_pValidFrames, AkUInt16 in_uNumVoices);
+    AKRESULT TimeSkip(AkUInt32 in_uFrames);
+
+    AutoCompressorFX* Plugin() const { return m_pPlugin; }
+    AkAudioBuffer* Buffer() { return &m_buffer; }
+
+private:
+    StandInAllocator* m_pAllocator = nullptr;
+    AutoCompressorFX* m_pPlugin = nullptr;
+    AutoCompressorFXParams* m_pParams = nullptr;
+    AkAudioBuffer m_buffer;
+    std::vector<AkReal32> m_storage;
+    AkUInt16 m_uNumChannels = 0;
+    AkUInt16 m_uMaxFrames = 0;
+};
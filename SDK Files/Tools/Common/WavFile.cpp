@@ -0,0 +1,321 @@
+#include "WavFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const AkUInt16 kFormatPcm = 1;
+    const AkUInt16 kFormatFloat = 3;
+    const AkUInt16 kFormatExtensible = 0xFFFE;
+    const size_t kHeaderSize = 44;          // RIFF + fmt + data headers of the files we write
+
+    AkUInt16 ReadU16(const AkUInt8* in_p)
+    {
+        return static_cast<AkUInt16>(in_p[0] | (in_p[1] << 8));
+    }
+
+    AkUInt32 ReadU32(const AkUInt8* in_p)
+    {
+        return static_cast<AkUInt32>(in_p[0]) | (static_cast<AkUInt32>(in_p[1]) << 8)
+            | (static_cast<AkUInt32>(in_p[2]) << 16) | (static_cast<AkUInt32>(in_p[3]) << 24);
+    }
+
+    void WriteU16(AkUInt8* out_p, AkUInt16 in_uValue)
+    {
+        out_p[0] = static_cast<AkUInt8>(in_uValue);
+        out_p[1] = static_cast<AkUInt8>(in_uValue >> 8);
+    }
+
+    void WriteU32(AkUInt8* out_p, AkUInt32 in_uValue)
+    {
+        for (int byte = 0; byte < 4; ++byte)
+        {
+            out_p[byte] = static_cast<AkUInt8>(in_uValue >> (8 * byte));
+        }
+    }
+
+    size_t PageFloor(size_t in_uBytes)
+    {
+        const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return in_uBytes - (in_uBytes % pageSize);
+    }
+
+    template <typename Convert>
+    void Deinterleave(const AkUInt8* in_pFrames, AkUInt16 in_uNumChannels, AkUInt16 in_uBytesPerSample, AkUInt32 in_uFrames, AkReal32* const* out_ppChannels, Convert in_convert)
+    {
+        const size_t frameBytes = static_cast<size_t>(in_uNumChannels) * in_uBytesPerSample;
+        for (AkUInt16 channel = 0; channel < in_uNumChannels; ++channel)
+        {
+            const AkUInt8* pSample = in_pFrames + (channel * in_uBytesPerSample);
+            AkReal32* AK_RESTRICT pOut = out_ppChannels[channel];
+            for (AkUInt32 frame = 0; frame < in_uFrames; ++frame, pSample += frameBytes)
+            {
+                pOut[frame] = in_convert(pSample);
+            }
+        }
+    }
+}
+
+WavReader::~WavReader()
+{
+    Close();
+}
+
+bool WavReader::Open(const std::string& in_path, std::string& out_error)
+{
+    Close();
+
+    m_fd = open(in_path.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if (m_fd < 0 || fstat(m_fd, &fileStat) != 0)
+    {
+        out_error = in_path + ": " + strerror(errno);
+        Close();
+        return false;
+    }
+
+    m_mappingSize = static_cast<size_t>(fileStat.st_size);
+    void* pMapping = (m_mappingSize >= 12) ? mmap(nullptr, m_mappingSize, PROT_READ, MAP_PRIVATE, m_fd, 0) : MAP_FAILED;
+    if (pMapping == MAP_FAILED)
+    {
+        out_error = in_path + ": can't be mapped";
+        m_mappingSize = 0;
+        Close();
+        return false;
+    }
+    m_pMapping = static_cast<const AkUInt8*>(pMapping);
+
+    if (memcmp(m_pMapping, "RIFF", 4) != 0 || memcmp(m_pMapping + 8, "WAVE", 4) != 0)
+    {
+        out_error = in_path + ": not a RIFF/WAVE file";
+        Close();
+        return false;
+    }
+
+    // Walk the chunks, fmt has to come before data
+    AkUInt16 formatTag = 0;
+    AkUInt16 bitsPerSample = 0;
+    size_t dataSize = 0;
+    size_t offset = 12;
+    while (offset + 8 <= m_mappingSize && m_dataOffset == 0)
+    {
+        const AkUInt8* pChunk = m_pMapping + offset;
+        const size_t chunkSize = ReadU32(pChunk + 4);
+        const size_t available = m_mappingSize - (offset + 8);
+
+        if (memcmp(pChunk, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= available)
+        {
+            formatTag = ReadU16(pChunk + 8);
+            m_uNumChannels = ReadU16(pChunk + 10);
+            m_uSampleRate = ReadU32(pChunk + 12);
+            bitsPerSample = ReadU16(pChunk + 22);
+            if (formatTag == kFormatExtensible && chunkSize >= 40)
+            {
+                formatTag = ReadU16(pChunk + 32);        // first two bytes of the sub-format GUID
+            }
+        }
+        else if (memcmp(pChunk, "data", 4) == 0 && formatTag != 0)
+        {
+            m_dataOffset = offset + 8;
+            dataSize = std::min(chunkSize, available);  // tolerate truncated files and streamed headers
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (formatTag == kFormatPcm && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32))
+    {
+        m_format = (bitsPerSample == 16) ? format_pcm16 : (bitsPerSample == 24) ? format_pcm24 : format_pcm32;
+    }
+    else if (formatTag == kFormatFloat && bitsPerSample == 32)
+    {
+        m_format = format_float32;
+    }
+    else
+    {
+        out_error = in_path + ": only 16/24/32-bit PCM and 32-bit float are supported";
+        Close();
+        return false;
+    }
+
+    if (m_dataOffset == 0 || m_uNumChannels == 0 || m_uNumChannels > 2 || m_uSampleRate == 0)
+    {
+        out_error = in_path + ": needs a fmt and a data chunk, with 1 or 2 channels";
+        Close();
+        return false;
+    }
+
+    m_uBytesPerSample = bitsPerSample / 8;
+    m_uNumFrames = dataSize / (static_cast<size_t>(m_uNumChannels) * m_uBytesPerSample);
+    madvise(const_cast<AkUInt8*>(m_pMapping), m_mappingSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+void WavReader::Close()
+{
+    if (m_pMapping != nullptr)
+    {
+        munmap(const_cast<AkUInt8*>(m_pMapping), m_mappingSize);
+        m_pMapping = nullptr;
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_mappingSize = 0;
+    m_dataOffset = 0;
+    m_releasedBytes = 0;
+    m_uNumChannels = 0;
+    m_uSampleRate = 0;
+    m_uNumFrames = 0;
+}
+
+void WavReader::ReadFrames(AkUInt64 in_uFirstFrame, AkUInt32 in_uFrames, AkReal32* const* out_ppChannels)
+{
+    const AkUInt8* pFrames = m_pMapping + m_dataOffset + (in_uFirstFrame * m_uNumChannels * m_uBytesPerSample);
+    switch (m_format)
+    {
+    case format_pcm16:
+        Deinterleave(pFrames, m_uNumChannels, m_uBytesPerSample, in_uFrames, out_ppChannels, [](const AkUInt8* p)
+        {
+            return static_cast<AkInt16>(ReadU16(p)) * (1.0f / 32768.0f);
+        });
+        break;
+    case format_pcm24:
+        Deinterleave(pFrames, m_uNumChannels, m_uBytesPerSample, in_uFrames, out_ppChannels, [](const AkUInt8* p)
+        {
+            const AkInt32 sample = static_cast<AkInt32>((p[0] << 8) | (p[1] << 16) | (static_cast<AkUInt32>(p[2]) << 24)) >> 8;
+            return sample * (1.0f / 8388608.0f);
+        });
+        break;
+    case format_pcm32:
+        Deinterleave(pFrames, m_uNumChannels, m_uBytesPerSample, in_uFrames, out_ppChannels, [](const AkUInt8* p)
+        {
+            return static_cast<AkReal32>(static_cast<AkInt32>(ReadU32(p)) * (1.0 / 2147483648.0));
+        });
+        break;
+    case format_float32:
+        Deinterleave(pFrames, m_uNumChannels, m_uBytesPerSample, in_uFrames, out_ppChannels, [](const AkUInt8* p)
+        {
+            AkReal32 sample;
+            memcpy(&sample, p, sizeof(sample));
+            return sample;
+        });
+        break;
+    }
+}
+
+void WavReader::Release(AkUInt64 in_uFrame)
+{
+    const size_t releasable = PageFloor(m_dataOffset + (in_uFrame * m_uNumChannels * m_uBytesPerSample));
+    if (releasable > m_releasedBytes)
+    {
+        madvise(const_cast<AkUInt8*>(m_pMapping) + m_releasedBytes, releasable - m_releasedBytes, MADV_DONTNEED);
+        m_releasedBytes = releasable;
+    }
+}
+
+WavWriter::~WavWriter()
+{
+    Close();
+}
+
+bool WavWriter::Create(const std::string& in_path, AkUInt16 in_uNumChannels, AkUInt32 in_uSampleRate, AkUInt64 in_uNumFrames, std::string& out_error)
+{
+    Close();
+
+    const AkUInt64 dataSize = in_uNumFrames * in_uNumChannels * sizeof(AkReal32);
+    if (dataSize > 0xFFFFFFFFull - kHeaderSize)
+    {
+        out_error = in_path + ": output would be over 4 GB, RF64 isn't supported";
+        return false;
+    }
+
+    m_fd = open(in_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    m_mappingSize = kHeaderSize + static_cast<size_t>(dataSize);
+    if (m_fd < 0 || ftruncate(m_fd, static_cast<off_t>(m_mappingSize)) != 0)
+    {
+        out_error = in_path + ": " + strerror(errno);
+        Close();
+        return false;
+    }
+
+    void* pMapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (pMapping == MAP_FAILED)
+    {
+        out_error = in_path + ": can't be mapped";
+        m_mappingSize = 0;
+        Close();
+        return false;
+    }
+    m_pMapping = static_cast<AkUInt8*>(pMapping);
+    m_uNumChannels = in_uNumChannels;
+
+    AkUInt8* pHeader = m_pMapping;
+    memcpy(pHeader, "RIFF", 4);
+    WriteU32(pHeader + 4, static_cast<AkUInt32>(m_mappingSize - 8));
+    memcpy(pHeader + 8, "WAVEfmt ", 8);
+    WriteU32(pHeader + 16, 16);
+    WriteU16(pHeader + 20, kFormatFloat);
+    WriteU16(pHeader + 22, in_uNumChannels);
+    WriteU32(pHeader + 24, in_uSampleRate);
+    WriteU32(pHeader + 28, in_uSampleRate * in_uNumChannels * sizeof(AkReal32));
+    WriteU16(pHeader + 32, static_cast<AkUInt16>(in_uNumChannels * sizeof(AkReal32)));
+    WriteU16(pHeader + 34, 32);
+    memcpy(pHeader + 36, "data", 4);
+    WriteU32(pHeader + 40, static_cast<AkUInt32>(dataSize));
+    return true;
+}
+
+void WavWriter::Close()
+{
+    if (m_pMapping != nullptr)
+    {
+        munmap(m_pMapping, m_mappingSize);
+        m_pMapping = nullptr;
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_mappingSize = 0;
+    m_releasedBytes = 0;
+    m_uNumChannels = 0;
+}
+
+void WavWriter::WriteFrames(AkUInt64 in_uFirstFrame, AkUInt32 in_uFrames, const AkReal32* const* in_ppChannels)
+{
+    AkUInt8* pFrames = m_pMapping + kHeaderSize + (in_uFirstFrame * m_uNumChannels * sizeof(AkReal32));
+    const size_t frameBytes = m_uNumChannels * sizeof(AkReal32);
+    for (AkUInt16 channel = 0; channel < m_uNumChannels; ++channel)
+    {
+        AkUInt8* pSample = pFrames + (channel * sizeof(AkReal32));
+        const AkReal32* AK_RESTRICT pIn = in_ppChannels[channel];
+        for (AkUInt32 frame = 0; frame < in_uFrames; ++frame, pSample += frameBytes)
+        {
+            memcpy(pSample, &pIn[frame], sizeof(AkReal32));
+        }
+    }
+}
+
+void WavWriter::Release(AkUInt64 in_uFrame)
+{
+    // the header page stays mapped, it is small and keeps the offsets simple
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t releasable = PageFloor(kHeaderSize + (in_uFrame * m_uNumChannels * sizeof(AkReal32)));
+    const size_t from = std::max(m_releasedBytes, pageSize);
+    if (releasable > from)
+    {
+        // queue the dirty pages for write-back so they don't pile up in the page cache, then drop them from the mapping
+        msync(m_pMapping + from, releasable - from, MS_ASYNC);
+        madvise(m_pMapping + from, releasable - from, MADV_DONTNEED);
+        m_releasedBytes = releasable;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <string>
+
+// Memory-mapped WAV files, so hour-long stems stream through the page cache instead of being loaded.
+// Frames are converted straight between the mapping and the deinterleaved float buffers the plug-in runs on,
+// and pages behind the cursor are handed back to the kernel as the render goes.
+// Supports 16/24/32-bit PCM and 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE. Output is always 32-bit float.
+
+class WavReader
+{
+public:
+    WavReader() = default;
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+    ~WavReader();
+
+    bool Open(const std::string& in_path, std::string& out_error);
+    void Close();
+
+    /// Converts in_uFrames frames starting at in_uFirstFrame into one float array per channel.
+    void ReadFrames(AkUInt64 in_uFirstFrame, AkUInt32 in_uFrames, AkReal32* const* out_ppChannels);
+
+    /// Lets the kernel drop the mapped pages before in_uFrame, they won't be read again.
+    void Release(AkUInt64 in_uFrame);
+
+    AkUInt16 NumChannels() const { return m_uNumChannels; }
+    AkUInt32 SampleRate() const { return m_uSampleRate; }
+    AkUInt64 NumFrames() const { return m_uNumFrames; }
+
+private:
+    enum SampleFormat
+    {
+        format_pcm16 = 0,
+        format_pcm24,
+        format_pcm32,
+        format_float32
+    };
+
+    int m_fd = -1;
+    const AkUInt8* m_pMapping = nullptr;
+    size_t m_mappingSize = 0;
+    size_t m_dataOffset = 0;
+    size_t m_releasedBytes = 0;
+    SampleFormat m_format = format_pcm16;
+    AkUInt16 m_uNumChannels = 0;
+    AkUInt16 m_uBytesPerSample = 0;
+    AkUInt32 m_uSampleRate = 0;
+    AkUInt64 m_uNumFrames = 0;
+};
+
+class WavWriter
+{
+public:
+    WavWriter() = default;
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+    ~WavWriter();
+
+    /// Sizes the file for in_uNumFrames up front and maps it, so writing never reallocates.
+    bool Create(const std::string& in_path, AkUInt16 in_uNumChannels, AkUInt32 in_uSampleRate, AkUInt64 in_uNumFrames, std::string& out_error);
+    void Close();
+
+    /// Interleaves in_uFrames frames from one float array per channel into the mapping.
+    void WriteFrames(AkUInt64 in_uFirstFrame, AkUInt32 in_uFrames, const AkReal32* const* in_ppChannels);
+
+    /// Starts writing back and unmaps the pages before in_uFrame, they won't be written again.
+    void Release(AkUInt64 in_uFrame);
+
+private:
+    int m_fd = -1;
+    AkUInt8* m_pMapping = nullptr;
+    size_t m_mappingSize = 0;
+    size_t m_releasedBytes = 0;
+    AkUInt16 m_uNumChannels = 0;
+};
@@ -37,8 +37,34 @@ AutoCompressorPlugin::~AutoCompressorPlugin()
 
 bool AutoCompressorPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
 {
-    // Write bank data here
-    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Placeholder"));
+    // Write bank data here, in the order AutoCompressorFXParams::SetParamsBlock reads it
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Threshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Priority"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Ratio"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Knee"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Attack"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Release"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "Group"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "Bands"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Crossover1"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Crossover2"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Crossover3"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band1Threshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band2Threshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band3Threshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band4Threshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band1Ratio"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band2Ratio"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band3Ratio"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Band4Ratio"));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, "AutoThreshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "AutoPercentile"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "AutoHorizon"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CullBelow"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CullKeep"));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, "TruePeak"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CpuBudget"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Hold"));
 
     return true;
 }
@@ -66,11 +66,13 @@ void AutoCompressorPluginGUI::NotifyMonitorData(AkTimeMs in_iTimeStamp, const AK
     if (m_hwndPropView != NULL &&
         in_pMonitorDataArray != nullptr)
     {
-        auto* serializedData = (std::string*)in_pMonitorDataArray->pData;
+        // two NUL terminated lines back to back, see AutoCompressorFX::finishTick
+        const char* sidechainText = (const char*)in_pMonitorDataArray->pData;
+        const char* envelopeText = sidechainText + strlen(sidechainText) + 1;
         HWND DlgLable1 = ::GetDlgItem(m_hwndPropView, IDC_DATA1);
-        ::SetWindowTextA(DlgLable1, serializedData[0].c_str());
+        ::SetWindowTextA(DlgLable1, sidechainText);
         HWND DlgLable2 = ::GetDlgItem(m_hwndPropView, IDC_DATA2);
-        ::SetWindowTextA(DlgLable2, serializedData[1].c_str());
+        ::SetWindowTextA(DlgLable2, envelopeText);
     }
 }
 